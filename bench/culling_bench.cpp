@@ -0,0 +1,72 @@
+#include "muffin/graphics/Culling.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Frustum-culls random bounding spheres with the scalar and SIMD paths and reports throughput
+// in objects tested per millisecond.
+
+static const size_t OBJECT_COUNTS[] = { 10000, 100000, 1000000 };
+static const int REPEATS = 20;
+
+template <typename F>
+static double bestOf(F&& fn)
+{
+	double best = 1e30;
+	for (int r = 0; r < REPEATS; r++) {
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		auto end = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	return best;
+}
+
+int main()
+{
+	glm::mat4 view = glm::lookAt(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+	glm::mat4 proj = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 150.f);
+	Frustum frustum = Frustum::FromMatrix(proj * view);
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> position(-100.f, 100.f);
+	std::uniform_real_distribution<float> radius(0.5f, 2.f);
+
+	printf("%10s %10s %16s %16s %8s\n", "objects", "visible", "scalar obj/ms", "simd obj/ms", "speedup");
+
+	for (size_t count : OBJECT_COUNTS) {
+		BoundingSphereArray spheres;
+		spheres.Resize(count);
+		for (size_t i = 0; i < count; i++) {
+			spheres.Set(i, BoundingSphere{ .center = glm::vec3(position(rng), position(rng), position(rng)), .radius = radius(rng) });
+		}
+
+		std::vector<uint32_t> visible;
+		visible.reserve(count);
+
+		size_t scalarVisible = 0;
+		double scalar = bestOf([&]() {
+			visible.clear();
+			scalarVisible = CullSpheresScalar(frustum, spheres, visible);
+		});
+
+		size_t simdVisible = 0;
+		double simd = bestOf([&]() {
+			visible.clear();
+			simdVisible = CullSpheres(frustum, spheres, visible);
+		});
+
+		if (scalarVisible != simdVisible) {
+			fprintf(stderr, "mismatch at %zu objects: scalar %zu, simd %zu\n", count, scalarVisible, simdVisible);
+			return 1;
+		}
+
+		printf("%10zu %10zu %16.0f %16.0f %7.2fx\n", count, simdVisible, count / scalar, count / simd, scalar / simd);
+	}
+
+	return 0;
+}
@@ -0,0 +1,96 @@
+#include "muffin/core/JobSystem.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Measures how the job system scales from one thread to every hardware thread on two workloads:
+// a flat parallel_for over independent items, and a recursive fork/join tree that relies on stealing.
+
+static const size_t ITEM_COUNT = 1 << 20;
+static const size_t GRAIN = 1024;
+static const uint32_t FORK_DEPTH = 16;
+static const int REPEATS = 5;
+
+static float work(size_t i)
+{
+	float x = float(i);
+	for (int k = 0; k < 64; k++) {
+		x = std::sqrt(x * x + 1.f) * 0.5f + std::sin(x);
+	}
+	return x;
+}
+
+static void parallelForWorkload(JobSystem& jobs, std::vector<float>& out)
+{
+	jobs.ParallelFor(out.size(), GRAIN, [&out](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			out[i] = work(i);
+		}
+	});
+}
+
+static float forkJoin(JobSystem& jobs, uint32_t depth, size_t index)
+{
+	if (depth == 0) {
+		float sum = 0.f;
+		for (size_t i = 0; i < 16; i++) {
+			sum += work(index * 16 + i);
+		}
+		return sum;
+	}
+
+	float left = 0.f;
+	JobCounter counter;
+	jobs.Run([&jobs, &left, depth, index]() { left = forkJoin(jobs, depth - 1, index * 2); }, &counter);
+	float right = forkJoin(jobs, depth - 1, index * 2 + 1);
+	jobs.Wait(counter);
+	return left + right;
+}
+
+template <typename F>
+static double bestOf(F&& fn)
+{
+	double best = 1e30;
+	for (int r = 0; r < REPEATS; r++) {
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		auto end = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	return best;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t maxThreads = JobSystem::DefaultWorkerCount() + 1;
+	if (argc > 1) {
+		maxThreads = std::max(1, atoi(argv[1]));
+	}
+
+	std::vector<float> out(ITEM_COUNT);
+	double parallelForBase = 0.0;
+	double forkJoinBase = 0.0;
+	volatile float sink = 0.f;
+
+	printf("%8s %16s %10s %16s %10s\n", "threads", "parallel_for ms", "speedup", "fork/join ms", "speedup");
+
+	for (uint32_t threads = 1; threads <= maxThreads; threads++) {
+		JobSystem jobs(threads - 1);
+
+		double parallelFor = bestOf([&]() { parallelForWorkload(jobs, out); });
+		double fork = bestOf([&]() { sink = sink + forkJoin(jobs, FORK_DEPTH, 0); });
+
+		if (threads == 1) {
+			parallelForBase = parallelFor;
+			forkJoinBase = fork;
+		}
+
+		printf("%8u %16.2f %9.2fx %16.2f %9.2fx\n", threads, parallelFor, parallelForBase / parallelFor, fork,
+			forkJoinBase / fork);
+	}
+
+	return 0;
+}
@@ -0,0 +1,383 @@
+#include "muffin/core/JobSystem.h"
+#include "muffin/core/Profiler.h"
+#include "muffin/graphics/Camera.h"
+#include "muffin/graphics/GeometryPool.h"
+#include "muffin/graphics/Material.h"
+#include "muffin/graphics/Mesh.h"
+#include "muffin/graphics/RenderObject.h"
+#include "muffin/graphics/Renderer.h"
+#include "muffin/graphics/Scene.h"
+#include "muffin/graphics/rhi/RHI.h"
+#include "muffin/graphics/rhi/vulkan/RHI.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Renders synthetic scenes of N objects drawn from M meshes and K materials, stacked in L depth layers
+// of overdraw, for a fixed number of frames through Renderer on the headless Vulkan path. Prints one JSON
+// document with per-frame CPU time, GPU time, draw and bind counts, driver and heap allocations for every scene,
+// so runs on different commits can be diffed. Expects vert.spv and frag.spv in the working directory.
+//
+// muffin_bench [--frames N] [--warmup N] [--scene name] [--out file]
+
+static const uint32_t WIDTH = 1280;
+static const uint32_t HEIGHT = 1024;
+static const uint32_t SEED = 1234;
+
+struct SceneConfig
+{
+	const char* name;
+	uint32_t objects;
+	uint32_t meshes;
+	uint32_t materials;
+	// Objects are split into this many layers covering the same screen area, front to back.
+	uint32_t layers;
+};
+
+static const SceneConfig SCENES[] = {
+	{ .name = "baseline", .objects = 1000, .meshes = 1, .materials = 1, .layers = 1 },
+	{ .name = "meshes", .objects = 1000, .meshes = 32, .materials = 1, .layers = 1 },
+	{ .name = "materials", .objects = 1000, .meshes = 1, .materials = 64, .layers = 1 },
+	{ .name = "mixed", .objects = 5000, .meshes = 16, .materials = 16, .layers = 1 },
+	{ .name = "overdraw", .objects = 2000, .meshes = 4, .materials = 4, .layers = 8 },
+};
+
+static std::atomic<uint64_t> allocations{ 0 };
+
+void* operator new(size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+static std::vector<uint32_t> readFile(const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::ate | std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("failed to open " + filename);
+	}
+
+	size_t fileSize = (size_t)file.tellg();
+	std::vector<uint32_t> buffer(fileSize / sizeof(uint32_t));
+	file.seekg(0);
+	file.read((char*)buffer.data(), fileSize);
+
+	return buffer;
+}
+
+// Unit-diameter UV sphere; meshes differ only in tessellation.
+static MeshRef createSphere(const GeometryPoolRef& geometry, uint32_t segments)
+{
+	uint32_t rings = segments / 2;
+
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> colors;
+	std::vector<glm::vec2> texCoords;
+	std::vector<uint16_t> indices;
+
+	for (uint32_t r = 0; r <= rings; r++) {
+		float phi = glm::pi<float>() * r / rings;
+		for (uint32_t s = 0; s <= segments; s++) {
+			float theta = 2.f * glm::pi<float>() * s / segments;
+			positions.emplace_back(0.5f * std::sin(phi) * std::cos(theta), 0.5f * std::sin(phi) * std::sin(theta), 0.5f * std::cos(phi));
+			colors.emplace_back(1.f, 1.f, 1.f);
+			texCoords.emplace_back(float(s) / segments, float(r) / rings);
+		}
+	}
+
+	for (uint32_t r = 0; r < rings; r++) {
+		for (uint32_t s = 0; s < segments; s++) {
+			uint16_t a = r * (segments + 1) + s;
+			uint16_t b = a + segments + 1;
+			indices.insert(indices.end(), { a, b, uint16_t(a + 1), uint16_t(a + 1), b, uint16_t(b + 1) });
+		}
+	}
+
+	return Mesh::Create(geometry, positions, indices, colors, texCoords);
+}
+
+// 4x4 texture of a single color, distinct per material.
+static RHITextureRef createTexture(const RHIDriverRef& driver, uint32_t index)
+{
+	uint32_t color = 0xff000000 | ((index * 2654435761u) & 0x00ffffff);
+	std::vector<uint32_t> pixels(16, color);
+
+	RHIBufferRef staging = driver->CreateBuffer(pixels.size() * sizeof(uint32_t), BufferInfo{ BufferUsage::Staging });
+	staging->Write(pixels.data(), pixels.size() * sizeof(uint32_t));
+
+	RHITextureRef texture = driver->CreateTexture(4, 4);
+	driver->CopyBufferToTexture(staging, texture, 4, 4);
+	return texture;
+}
+
+struct Summary
+{
+	double mean;
+	double p50;
+	double p95;
+};
+
+static Summary summarize(std::vector<double> values)
+{
+	if (values.empty()) {
+		return Summary{ 0, 0, 0 };
+	}
+
+	std::sort(values.begin(), values.end());
+	double sum = 0;
+	for (double v : values) {
+		sum += v;
+	}
+	return Summary{
+		.mean = sum / values.size(),
+		.p50 = values[values.size() / 2],
+		.p95 = values[std::min(values.size() - 1, values.size() * 95 / 100)],
+	};
+}
+
+struct SceneResult
+{
+	Summary cpuMs;
+	Summary gpuMs;
+	// Per-frame means.
+	double draws;
+	double instances;
+	double triangles;
+	double pipelineBinds;
+	double descriptorSetBinds;
+	double vertexBufferBinds;
+	double descriptorSetsAllocated;
+	double fenceWaitMs;
+	// Driver-side: vkAllocateMemory calls, and buffers and textures created.
+	double memoryAllocations;
+	double buffersCreated;
+	double texturesCreated;
+	// Global operator new calls.
+	double allocations;
+};
+
+static SceneResult runScene(const RHIDriverRef& driver, const JobSystemRef& jobs, const RHIShaderRef& vert,
+	const RHIShaderRef& frag, const SceneConfig& config, uint32_t warmupFrames, uint32_t frames)
+{
+	std::mt19937 rng(SEED);
+
+	GeometryPoolRef geometry = std::make_shared<GeometryPool>(driver);
+	std::vector<MeshRef> meshes;
+	for (uint32_t i = 0; i < config.meshes; i++) {
+		meshes.push_back(createSphere(geometry, 8 + 4 * (i % 8)));
+	}
+
+	std::vector<MaterialRef> materials;
+	for (uint32_t i = 0; i < config.materials; i++) {
+		materials.push_back(Material::Create(driver, vert, frag, createTexture(driver, i)));
+	}
+
+	// Each layer is a grid filling the view; later layers sit behind the earlier ones.
+	Scene scene;
+	uint32_t perLayer = (config.objects + config.layers - 1) / config.layers;
+	uint32_t columns = (uint32_t)std::ceil(std::sqrt(float(perLayer)));
+	float cell = 20.f / columns;
+
+	std::uniform_int_distribution<uint32_t> pickMesh(0, config.meshes - 1);
+	std::uniform_int_distribution<uint32_t> pickMaterial(0, config.materials - 1);
+
+	for (uint32_t i = 0; i < config.objects; i++) {
+		uint32_t layer = i / perLayer;
+		uint32_t slot = i % perLayer;
+		glm::vec3 position(-10.f + cell * (slot % columns + 0.5f), -10.f + cell * (slot / columns + 0.5f), -2.f * layer);
+
+		RenderObjectRef obj = RenderObject::Create("Object" + std::to_string(i), meshes[pickMesh(rng)], materials[pickMaterial(rng)]);
+		scene.AddObject(obj);
+		obj->SetTransform(glm::scale(glm::translate(glm::mat4(1.f), position), glm::vec3(cell * 0.9f)));
+	}
+
+	Camera camera;
+	camera.LookAt(glm::vec3(0.f, 0.f, 25.f), glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+	camera.SetPerspective(glm::radians(45.f), 800.f / 600.f, 0.1f, 100.f);
+	Frustum frustum = Frustum::FromMatrix(camera.ViewProjection());
+
+	Renderer renderer(driver, jobs);
+	std::vector<RenderObjectRef> visible;
+
+	std::vector<double> cpuMs;
+	std::vector<double> gpuMs;
+	SceneResult result{};
+
+	for (uint32_t frame = 0; frame < warmupFrames + frames; frame++) {
+		bool measured = frame >= warmupFrames;
+		uint64_t allocationsBefore = allocations.load(std::memory_order_relaxed);
+		auto start = std::chrono::steady_clock::now();
+
+		Profiler::Get().BeginFrame();
+		scene.Update();
+
+		visible.clear();
+		scene.Cull(frustum, visible);
+		for (const RenderObjectRef& obj : visible) {
+			renderer.Enqueue(obj);
+		}
+
+		renderer.SetCamera(camera);
+		renderer.Render();
+
+		auto end = std::chrono::steady_clock::now();
+		if (!measured) {
+			continue;
+		}
+
+		cpuMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+		// Timings of a frame finished earlier; the lag does not matter for a steady scene.
+		uint64_t gpuNs = 0;
+		for (const GpuTiming& timing : driver->GpuTimings()) {
+			if (!strcmp(timing.name, "Render pass")) {
+				gpuNs += timing.end - timing.begin;
+			}
+		}
+		if (gpuNs) {
+			gpuMs.push_back(gpuNs / 1e6);
+		}
+
+		const CommandListStats& stats = renderer.LastFrameStats();
+		result.draws += stats.draws;
+		result.instances += stats.instances;
+		result.triangles += stats.triangles;
+		result.pipelineBinds += stats.pipelineBinds;
+		result.descriptorSetBinds += stats.descriptorSetBinds;
+		result.vertexBufferBinds += stats.vertexBufferBinds;
+
+		// Closed by the BeginFrame in Render, so one frame behind like the GPU timings.
+		RHIStats driverStats = driver->FrameStats();
+		result.descriptorSetsAllocated += driverStats.descriptorSetsAllocated;
+		result.fenceWaitMs += driverStats.fenceWaitNs / 1e6;
+		result.memoryAllocations += driverStats.memoryAllocations;
+		result.buffersCreated += driverStats.buffersCreated;
+		result.texturesCreated += driverStats.texturesCreated;
+
+		result.allocations += allocations.load(std::memory_order_relaxed) - allocationsBefore;
+	}
+
+	driver->WaitIdle();
+
+	result.cpuMs = summarize(cpuMs);
+	result.gpuMs = summarize(gpuMs);
+	result.draws /= frames;
+	result.instances /= frames;
+	result.triangles /= frames;
+	result.pipelineBinds /= frames;
+	result.descriptorSetBinds /= frames;
+	result.vertexBufferBinds /= frames;
+	result.descriptorSetsAllocated /= frames;
+	result.fenceWaitMs /= frames;
+	result.memoryAllocations /= frames;
+	result.buffersCreated /= frames;
+	result.texturesCreated /= frames;
+	result.allocations /= frames;
+	return result;
+}
+
+static void printSummary(FILE* out, const char* name, const Summary& summary)
+{
+	fprintf(out, "\"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f }", name, summary.mean, summary.p50, summary.p95);
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t frames = 200;
+	uint32_t warmupFrames = 20;
+	std::string only;
+	std::string outFile;
+
+	for (int i = 1; i < argc; i += 2) {
+		std::string arg = argv[i];
+		if (i + 1 == argc) {
+			fprintf(stderr, "missing value for option %s\n", argv[i]);
+			return 1;
+		}
+		if (arg == "--frames") {
+			frames = std::max(1, atoi(argv[i + 1]));
+		} else if (arg == "--warmup") {
+			warmupFrames = atoi(argv[i + 1]);
+		} else if (arg == "--scene") {
+			only = argv[i + 1];
+		} else if (arg == "--out") {
+			outFile = argv[i + 1];
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	FILE* out = outFile.empty() ? stdout : fopen(outFile.c_str(), "w");
+	if (!out) {
+		fprintf(stderr, "failed to open %s\n", outFile.c_str());
+		return 1;
+	}
+
+	// Without the validation layer, which would dominate the CPU frame time.
+	RHIDriverRef driver = CreateHeadlessVulkanRhi(WIDTH, HEIGHT, false);
+	JobSystemRef jobs = std::make_shared<JobSystem>();
+
+	RHIShaderRef vert = driver->CreateShader(readFile("vert.spv"), ShaderType::Vertex);
+	RHIShaderRef frag = driver->CreateShader(readFile("frag.spv"), ShaderType::Fragment);
+
+	fprintf(out, "{\n  \"width\": %u, \"height\": %u, \"frames\": %u, \"warmup\": %u, \"workers\": %u,\n  \"scenes\": [",
+		WIDTH, HEIGHT, frames, warmupFrames, jobs->WorkerCount());
+
+	bool first = true;
+	for (const SceneConfig& config : SCENES) {
+		if (!only.empty() && only != config.name) {
+			continue;
+		}
+
+		SceneResult result = runScene(driver, jobs, vert, frag, config, warmupFrames, frames);
+
+		fprintf(out, "%s\n    { \"name\": \"%s\", \"objects\": %u, \"meshes\": %u, \"materials\": %u, \"layers\": %u,\n      ",
+			first ? "" : ",", config.name, config.objects, config.meshes, config.materials, config.layers);
+		printSummary(out, "cpu_ms", result.cpuMs);
+		fprintf(out, ",\n      ");
+		printSummary(out, "gpu_ms", result.gpuMs);
+		fprintf(out, ",\n      \"draws\": %.1f, \"instances\": %.1f, \"triangles\": %.1f, \"pipeline_binds\": %.1f, "
+					 "\"descriptor_set_binds\": %.1f, \"vertex_buffer_binds\": %.1f,\n      \"descriptor_sets_allocated\": %.1f, "
+					 "\"fence_wait_ms\": %.4f,\n      \"memory_allocations\": %.1f, \"buffers_created\": %.1f, "
+					 "\"textures_created\": %.1f, \"allocations\": %.1f }",
+			result.draws, result.instances, result.triangles, result.pipelineBinds, result.descriptorSetBinds,
+			result.vertexBufferBinds, result.descriptorSetsAllocated, result.fenceWaitMs, result.memoryAllocations,
+			result.buffersCreated, result.texturesCreated, result.allocations);
+		first = false;
+	}
+
+	fprintf(out, "\n  ]\n}\n");
+
+	if (out != stdout) {
+		fclose(out);
+	}
+	return 0;
+}
@@ -0,0 +1,85 @@
+#include "muffin/graphics/Scene.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Looks up objects in a 100k-object scene by name through the hash index, by handle through the slot map,
+// and by the linear name scan the index replaced, and times add/remove churn.
+
+static const size_t OBJECT_COUNT = 100000;
+static const size_t LOOKUPS = 1000000;
+static const size_t LINEAR_LOOKUPS = 1000;
+
+template <typename F>
+static double nsPerOp(size_t ops, F&& fn)
+{
+	auto start = std::chrono::steady_clock::now();
+	fn();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+int main()
+{
+	// Mesh-less objects: the scene indexes them by name and handle but keeps them out of the BVH.
+	Scene scene;
+	std::vector<std::string> names;
+	std::vector<SlotHandle> handles;
+	for (size_t i = 0; i < OBJECT_COUNT; i++) {
+		names.push_back("Object" + std::to_string(i));
+		handles.push_back(scene.AddObject(RenderObject::Create(names.back(), nullptr, nullptr)));
+	}
+
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<size_t> pick(0, OBJECT_COUNT - 1);
+	std::vector<size_t> order(LOOKUPS);
+	for (size_t& i : order) {
+		i = pick(rng);
+	}
+
+	size_t found = 0;
+
+	double byName = nsPerOp(LOOKUPS, [&]() {
+		for (size_t i : order) {
+			found += scene.GetObject(names[i]) != nullptr;
+		}
+	});
+
+	double byHandle = nsPerOp(LOOKUPS, [&]() {
+		for (size_t i : order) {
+			found += scene.GetObject(handles[i]) != nullptr;
+		}
+	});
+
+	double linear = nsPerOp(LINEAR_LOOKUPS, [&]() {
+		for (size_t n = 0; n < LINEAR_LOOKUPS; n++) {
+			const std::string& name = names[order[n]];
+			for (const RenderObjectRef& obj : scene.GetObjects()) {
+				if (obj->Name() == name) {
+					found++;
+					break;
+				}
+			}
+		}
+	});
+
+	double churn = nsPerOp(2 * LINEAR_LOOKUPS * 10, [&]() {
+		for (size_t n = 0; n < LINEAR_LOOKUPS * 10; n++) {
+			size_t i = order[n];
+			RenderObjectRef obj = scene.GetObject(handles[i]);
+			scene.RemoveObject(handles[i]);
+			handles[i] = scene.AddObject(obj);
+		}
+	});
+
+	printf("objects:            %zu\n", OBJECT_COUNT);
+	printf("lookup by name:     %8.1f ns\n", byName);
+	printf("lookup by handle:   %8.1f ns\n", byHandle);
+	printf("linear name scan:   %8.1f ns\n", linear);
+	printf("add/remove:         %8.1f ns\n", churn);
+
+	return found == 0;
+}
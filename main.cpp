@@ -1,4 +1,10 @@
+#include "muffin/core/JobSystem.h"
+#include "muffin/core/Profiler.h"
 #include "muffin/editor/ImGuiRenderer.h"
+#include "muffin/editor/ProfilerWindow.h"
+#include "muffin/editor/RHIStatsWindow.h"
+#include "muffin/graphics/Camera.h"
+#include "muffin/graphics/GpuCulling.h"
 #include "muffin/graphics/Material.h"
 #include "muffin/graphics/Mesh.h"
 #include "muffin/graphics/RenderObject.h"
@@ -44,7 +50,34 @@ static std::vector<uint32_t> readFile(const std::string& filename)
 	return buffer;
 }
 
-void DrawGUI(Scene& scene)
+// Binary PPM of a read-back frame; alpha is dropped.
+static void writePpm(const std::string& filename, const FrameImage& image)
+{
+	std::ofstream file(filename, std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("failed to open " + filename);
+	}
+
+	file << "P6\n" << image.width << " " << image.height << "\n255\n";
+	for (size_t i = 0; i < image.pixels.size(); i += 4) {
+		file.write((const char*)&image.pixels[i], 3);
+	}
+}
+
+// Ray through a pixel of the viewport the renderer draws into, for picking.
+static void viewportRay(const Camera& camera, int x, int y, glm::vec3& origin, glm::vec3& direction)
+{
+	glm::vec2 ndc((x - 200.f) / 800.f * 2.f - 1.f, (y - 200.f) / 600.f * 2.f - 1.f);
+	glm::mat4 inverseViewProj = glm::inverse(camera.ViewProjection());
+
+	glm::vec4 nearPoint = inverseViewProj * glm::vec4(ndc.x, ndc.y, 0.f, 1.f);
+	glm::vec4 farPoint = inverseViewProj * glm::vec4(ndc.x, ndc.y, 1.f, 1.f);
+
+	origin = glm::vec3(nearPoint) / nearPoint.w;
+	direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+}
+
+void DrawGUI(Scene& scene, RHIDriver& driver, RenderObjectRef& picked)
 {
 	static float f = 0.0f;
 	static int counter = 0;
@@ -58,61 +91,116 @@ void DrawGUI(Scene& scene)
 		}
 	}
 
+	ImGui::Text("Picked: %s", picked ? picked->Name().c_str() : "none");
+	if (picked && ImGui::Button("Rotate picked")) {
+		picked->SetTransform(glm::rotate(picked->GetTransform(), glm::radians(15.f), glm::vec3(0, 0, 1)));
+	}
+
 	ImGui::End();
+
+	DrawProfilerWindow(Profiler::Get());
+	DrawRHIStatsWindow(driver);
 }
 
-int main()
+int main(int argc, char** argv)
 {
+	bool bindless = false;
+	bool gpuCulling = false;
+	bool headless = false;
+	bool validation = false;
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--bindless") {
+			bindless = true;
+		}
+		if (std::string(argv[i]) == "--gpu-culling") {
+			gpuCulling = true;
+		}
+		// Renders HEADLESS_FRAMES frames offscreen, reports the frame rate and saves the last frame to frame.ppm.
+		if (std::string(argv[i]) == "--headless") {
+			headless = true;
+		}
+		if (std::string(argv[i]) == "--validation") {
+			validation = true;
+		}
+	}
+
+	const uint32_t HEADLESS_FRAMES = 500;
+
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
 	ImGuiIO& io = ImGui::GetIO();
 	(void)io;
 	ImGui::StyleColorsDark();
 
-	auto startTime = std::chrono::high_resolution_clock::now();
-
-	UniformBufferObject ubo{};
-
-	tinyobj::attrib_t attrib;
-	std::vector<tinyobj::shape_t> shapes;
-	std::vector<tinyobj::material_t> materials;
-	std::string warn, err;
-
-	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, "viking_room.obj")) {
-		throw std::runtime_error(warn + err);
-	}
+	JobSystemRef jobs = std::make_shared<JobSystem>();
 
 	std::vector<glm::vec3> positions;
 	std::vector<glm::vec3> colors;
 	std::vector<glm::vec2> texCoords;
 	std::vector<uint16_t> indices;
+	std::string loadError;
+
+	int texWidth, texHeight, texChannels;
+	stbi_uc* pixels = nullptr;
+
+	// Parsing the model and decoding the texture are independent, so they load side by side.
+	JobCounter loading;
+
+	jobs->Run([&]() {
+		tinyobj::attrib_t attrib;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+		std::string warn, err;
 
-	for (const auto& shape : shapes) {
-		for (const auto& index : shape.mesh.indices) {
-			positions.emplace_back(attrib.vertices[3 * index.vertex_index + 0],
-				attrib.vertices[3 * index.vertex_index + 1],
-				attrib.vertices[3 * index.vertex_index + 2]);
-			colors.emplace_back(1.0f, 1.0f, 1.0f);
-			texCoords.emplace_back(attrib.texcoords[2 * index.texcoord_index + 0],
-				1.0f - attrib.texcoords[2 * index.texcoord_index + 1]);
-			indices.push_back(indices.size());
+		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, "viking_room.obj")) {
+			loadError = warn + err;
+			return;
 		}
+
+		for (const auto& shape : shapes) {
+			for (const auto& index : shape.mesh.indices) {
+				positions.emplace_back(attrib.vertices[3 * index.vertex_index + 0],
+					attrib.vertices[3 * index.vertex_index + 1],
+					attrib.vertices[3 * index.vertex_index + 2]);
+				colors.emplace_back(1.0f, 1.0f, 1.0f);
+				texCoords.emplace_back(attrib.texcoords[2 * index.texcoord_index + 0],
+					1.0f - attrib.texcoords[2 * index.texcoord_index + 1]);
+				indices.push_back(indices.size());
+			}
+		}
+	}, &loading);
+
+	jobs->Run([&]() { pixels = stbi_load("viking_room.png", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha); }, &loading);
+
+	// Device creation overlaps with the loads above.
+	RHIDriverRef rhi = headless ? CreateHeadlessVulkanRhi(1280, 1024, validation) : CreateVulkanRhi(validation);
+
+	jobs->Wait(loading);
+
+	if (!loadError.empty()) {
+		throw std::runtime_error(loadError);
 	}
 
-	RHIDriverRef rhi = CreateVulkanRhi();
+	Renderer renderer(rhi, jobs);
 
-	Renderer renderer(rhi);
+	GeometryPoolRef geometry = std::make_shared<GeometryPool>(rhi);
+	MeshRef mesh = Mesh::Create(geometry, positions, indices, colors, texCoords);
 
-	MeshRef mesh = Mesh::Create(rhi, positions, indices, colors, texCoords);
+	if (gpuCulling && !rhi->SupportsDrawIndirectFirstInstance()) {
+		printf("GPU culling needs drawIndirectFirstInstance, which this device lacks; culling on the CPU\n");
+		gpuCulling = false;
+	}
+
+	if (bindless && !rhi->SupportsBindless()) {
+		printf("bindless resources are not supported by this device, using descriptor sets\n");
+		bindless = false;
+	}
 
 	auto vertFile = readFile("vert.spv");
-	auto fragFile = readFile("frag.spv");
+	auto fragFile = readFile(bindless ? "frag_bindless.spv" : "frag.spv");
 	auto vert = rhi->CreateShader(vertFile, ShaderType::Vertex);
 	auto frag = rhi->CreateShader(fragFile, ShaderType::Fragment);
 
-	int texWidth, texHeight, texChannels;
-	stbi_uc* pixels = stbi_load("viking_room.png", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-
 	auto imgBuffer = rhi->CreateBuffer(texWidth * texHeight * 4, BufferInfo{ BufferUsage::Staging });
 	imgBuffer->Write(pixels, texWidth * texHeight * 4);
 	stbi_image_free(pixels);
@@ -121,12 +209,11 @@ int main()
 
 	rhi->CopyBufferToTexture(imgBuffer, texture, texWidth, texHeight);
 
-	MaterialRef material = Material::Create(rhi, vert, frag, texture);
-
-	MaterialRef material2 = Material::Create(rhi, vert, frag, texture);
+	MaterialRef material = bindless ? Material::CreateBindless(rhi, Material::CreatePipeline(rhi, vert, frag), texture)
+									: Material::Create(rhi, vert, frag, texture);
 
 	RenderObjectRef obj1 = RenderObject::Create("Object1", mesh, material);
-	RenderObjectRef obj2 = RenderObject::Create("Object2", mesh, material2);
+	RenderObjectRef obj2 = RenderObject::Create("Object2", mesh, material);
 
 	glm::mat4 obj1Transform = glm::translate(glm::mat4(1.0f), glm::vec3(2, 0, 0));
 	glm::mat4 obj2Transform = glm::translate(glm::mat4(1.0f), glm::vec3(-2, 0, 0));
@@ -136,9 +223,9 @@ int main()
 	bool show_demo_window = true;
 	ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
-	ubo.view = glm::lookAt(glm::vec3(0.0f, 5.0f, 5.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-	ubo.proj = glm::perspective(glm::radians(45.0f), 800.f / 600.f, 0.1f, 10.0f);
-	ubo.proj[1][1] *= -1;
+	Camera camera;
+	camera.LookAt(glm::vec3(0.0f, 5.0f, 5.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	camera.SetPerspective(glm::radians(45.0f), 800.f / 600.f, 0.1f, 10.0f);
 
 	obj1->SetTransform(obj1Transform);
 	obj2->SetTransform(obj2Transform);
@@ -148,34 +235,91 @@ int main()
 	scene.AddObject(obj1);
 	scene.AddObject(obj2);
 
-	auto gui = std::make_shared<ImGuiRenderer>(rhi);
+	std::shared_ptr<ImGuiRenderer> gui;
+	if (!headless) {
+		gui = std::make_shared<ImGuiRenderer>(rhi);
+	}
+
+	// The scene's objects are static here, so the GPU culler's groups are built once.
+	GpuCullingRef culling;
+	if (gpuCulling) {
+		auto cull = rhi->CreateShader(readFile("cull.spv"), ShaderType::Compute);
+		culling = std::make_shared<GpuCulling>(rhi, cull);
+		culling->SetObjects(scene.GetObjects());
+		renderer.SetGpuCulling(culling);
+	}
+
+	std::vector<RenderObjectRef> visibleObjects;
+	RenderObjectRef picked;
+	uint32_t frames = 0;
+	auto loopStartTime = std::chrono::high_resolution_clock::now();
 
 	while (!exit) {
-		SDL_Event e;
-		SDL_PollEvent(&e);
+		Profiler::Get().BeginFrame();
 
-		ImGui_ImplSDL2_ProcessEvent(&e);
+		if (!headless) {
+			SDL_Event e;
+			SDL_PollEvent(&e);
 
-		if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) {
-			exit = true;
+			ImGui_ImplSDL2_ProcessEvent(&e);
+
+			if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) {
+				exit = true;
+			}
+
+			if (e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT && !io.WantCaptureMouse) {
+				glm::vec3 origin, direction;
+				viewportRay(camera, e.button.x, e.button.y, origin, direction);
+				picked = scene.Pick(origin, direction);
+			}
 		}
 
-		auto currentTime = std::chrono::high_resolution_clock::now();
-		float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+		{
+			MUFFIN_PROFILE_SCOPE("Scene update");
+			const std::vector<TransformId>& changed = scene.Update();
+			if (culling) {
+				culling->TransformsChanged(changed);
+			}
+		}
+
+		if (!gpuCulling) {
+			MUFFIN_PROFILE_SCOPE("Cull");
+			visibleObjects.clear();
+			scene.Cull(Frustum::FromMatrix(camera.ViewProjection()), visibleObjects);
+			for (const RenderObjectRef& obj : visibleObjects) {
+				renderer.Enqueue(obj);
+			}
+		}
 
-		renderer.Enqueue(obj1);
-		renderer.Enqueue(obj2);
-		renderer.Enqueue(gui);
+		if (gui) {
+			MUFFIN_PROFILE_SCOPE("GUI");
+			renderer.Enqueue(gui);
 
-		ImGui_ImplSDL2_NewFrame();
-		ImGui::NewFrame();
+			ImGui_ImplSDL2_NewFrame();
+			ImGui::NewFrame();
 
-		DrawGUI(scene);
+			DrawGUI(scene, *rhi, picked);
 
-		ImGui::Render();
+			ImGui::Render();
+		}
 
+		renderer.SetCamera(camera);
 		renderer.Render();
+
+		if (headless && ++frames == HEADLESS_FRAMES) {
+			exit = true;
+		}
 	}
 	rhi->WaitIdle();
+
+	if (headless) {
+		float seconds = std::chrono::duration<float, std::chrono::seconds::period>(
+			std::chrono::high_resolution_clock::now() - loopStartTime).count();
+		printf("%u frames in %.2f s (%.1f fps)\n", frames, seconds, frames / seconds);
+
+		FrameImage image;
+		rhi->ReadbackFrame(image);
+		writePpm("frame.ppm", image);
+	}
 	return 0;
 }
@@ -0,0 +1,201 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local size_t currentQueue = 0;
+
+bool JobCounter::Done() const
+{
+	return pending.load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+	// The last queue is shared by every thread that is not one of our workers.
+	for (uint32_t i = 0; i <= workerCount; i++) {
+		queues.emplace_back(new WorkQueue());
+	}
+
+	for (uint32_t i = 0; i < workerCount; i++) {
+		workers.emplace_back(&JobSystem::workerMain, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	wakeUp.notify_all();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+uint32_t JobSystem::DefaultWorkerCount()
+{
+	return std::max(1u, std::thread::hardware_concurrency()) - 1;
+}
+
+uint32_t JobSystem::WorkerCount() const
+{
+	return workers.size();
+}
+
+void JobSystem::Run(Job job, JobCounter* counter)
+{
+	if (counter) {
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	}
+	push(Task{ .job = std::move(job), .counter = counter });
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, Job job, JobCounter* counter)
+{
+	if (counter) {
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(dependency.mutex);
+		if (dependency.pending.load(std::memory_order_acquire) != 0) {
+			dependency.continuations.push_back(JobCounter::Continuation{ .job = std::move(job), .counter = counter });
+			return;
+		}
+	}
+	push(Task{ .job = std::move(job), .counter = counter });
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	while (!counter.Done()) {
+		Task task;
+		if (pop(task)) {
+			execute(task);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	// The last job decrements under this lock; taking it once makes sure it is done touching the counter.
+	std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn)
+{
+	grain = std::max<size_t>(grain, 1);
+	if (count <= grain) {
+		if (count > 0) {
+			fn(0, count);
+		}
+		return;
+	}
+
+	JobCounter counter;
+	for (size_t begin = 0; begin < count; begin += grain) {
+		size_t end = std::min(begin + grain, count);
+		Run([&fn, begin, end]() { fn(begin, end); }, &counter);
+	}
+	Wait(counter);
+}
+
+size_t JobSystem::ownQueue() const
+{
+	return currentSystem == this ? currentQueue : queues.size() - 1;
+}
+
+void JobSystem::push(Task task)
+{
+	// Counted before the push so the count never dips below the number of queued tasks.
+	queuedTasks.fetch_add(1, std::memory_order_release);
+	{
+		WorkQueue& queue = *queues[ownQueue()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wakeUp.notify_one();
+}
+
+bool JobSystem::pop(Task& task)
+{
+	size_t own = ownQueue();
+	{
+		WorkQueue& queue = *queues[own];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty()) {
+			// Newest first: it is most likely still in cache, and it keeps nested Wait() calls depth-first.
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return steal(task, own);
+}
+
+bool JobSystem::steal(Task& task, size_t thief)
+{
+	for (size_t i = 1; i < queues.size(); i++) {
+		WorkQueue& queue = *queues[(thief + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty()) {
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::execute(Task& task)
+{
+	task.job();
+	finish(task.counter);
+}
+
+void JobSystem::finish(JobCounter* counter)
+{
+	if (!counter) {
+		return;
+	}
+
+	std::vector<JobCounter::Continuation> ready;
+	{
+		std::lock_guard<std::mutex> lock(counter->mutex);
+		if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			ready.swap(counter->continuations);
+		}
+	}
+
+	for (JobCounter::Continuation& continuation : ready) {
+		push(Task{ .job = std::move(continuation.job), .counter = continuation.counter });
+	}
+}
+
+void JobSystem::workerMain(uint32_t index)
+{
+	currentSystem = this;
+	currentQueue = index;
+
+	while (true) {
+		Task task;
+		if (pop(task)) {
+			execute(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeUp.wait(lock, [this]() { return stopping || queuedTasks.load(std::memory_order_acquire) > 0; });
+		if (stopping) {
+			return;
+		}
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using Job = std::function<void()>;
+
+// Number of jobs still running in a group. A counter can be waited on, or used as the dependency
+// of jobs that should only start once the whole group has finished.
+class JobCounter
+{
+public:
+	bool Done() const;
+
+private:
+	friend class JobSystem;
+
+	struct Continuation
+	{
+		Job job;
+		JobCounter* counter;
+	};
+
+	std::atomic<uint32_t> pending{ 0 };
+	std::mutex mutex;
+	std::vector<Continuation> continuations;
+};
+
+// Work-stealing scheduler. Every worker owns a deque: it pushes and pops its own jobs at the back,
+// and idle workers steal from the front of the others. Threads waiting on a counter, including
+// the main thread, run jobs themselves instead of blocking.
+class JobSystem
+{
+public:
+	// workerCount threads are spawned in addition to the calling thread; 0 runs everything inside Wait().
+	explicit JobSystem(uint32_t workerCount = DefaultWorkerCount());
+
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	void Run(Job job, JobCounter* counter = nullptr);
+
+	// Runs job once dependency has reached zero.
+	void RunAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+
+	void Wait(JobCounter& counter);
+
+	// Calls fn(begin, end) over [0, count) in ranges of at most grain elements, and returns when all are done.
+	void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+	uint32_t WorkerCount() const;
+
+	// One worker per hardware thread besides the caller's.
+	static uint32_t DefaultWorkerCount();
+
+private:
+	struct Task
+	{
+		Job job;
+		JobCounter* counter;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void push(Task task);
+
+	bool pop(Task& task);
+
+	bool steal(Task& task, size_t thief);
+
+	size_t ownQueue() const;
+
+	void execute(Task& task);
+
+	void finish(JobCounter* counter);
+
+	void workerMain(uint32_t index);
+
+	std::vector<std::unique_ptr<WorkQueue>> queues;
+	std::vector<std::thread> workers;
+
+	std::atomic<size_t> queuedTasks{ 0 };
+	std::atomic<bool> stopping{ false };
+
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+};
+
+using JobSystemRef = std::shared_ptr<JobSystem>;
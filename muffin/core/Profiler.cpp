@@ -0,0 +1,166 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+static std::string escapeJson(const char* text)
+{
+	std::string result;
+	for (const char* c = text; *c; c++) {
+		if (*c == '"' || *c == '\\') {
+			result += '\\';
+		}
+		result += *c;
+	}
+	return result;
+}
+
+Profiler& Profiler::Get()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Profiler()
+	: frameBegin(Now()), cpuFrameTimes{}, gpuFrameTimes{}, historyIndex(0), capturing(false), captureBegin(0)
+{
+}
+
+uint64_t Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t Profiler::ThreadIndex()
+{
+	static std::atomic<uint32_t> nextIndex{ 0 };
+	static thread_local uint32_t index = nextIndex++;
+	return index;
+}
+
+void Profiler::BeginFrame()
+{
+	uint64_t now = Now();
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	uint64_t gpuBegin = std::numeric_limits<uint64_t>::max();
+	uint64_t gpuEnd = 0;
+	for (const ProfileEvent& event : currentEvents) {
+		if (event.track == ProfileTrack::Gpu) {
+			gpuBegin = std::min(gpuBegin, event.begin);
+			gpuEnd = std::max(gpuEnd, event.end);
+		}
+	}
+
+	cpuFrameTimes[historyIndex] = (now - frameBegin) / 1e6f;
+	gpuFrameTimes[historyIndex] = gpuEnd > gpuBegin ? (gpuEnd - gpuBegin) / 1e6f : 0.f;
+	historyIndex = (historyIndex + 1) % PROFILER_HISTORY_FRAMES;
+
+	if (capturing) {
+		captured.insert(captured.end(), currentEvents.begin(), currentEvents.end());
+	}
+
+	std::swap(lastEvents, currentEvents);
+	currentEvents.clear();
+	frameBegin = now;
+}
+
+void Profiler::AddEvent(const ProfileEvent& event)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	currentEvents.push_back(event);
+}
+
+void Profiler::FrameTimes(std::vector<float>& cpu, std::vector<float>& gpu)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	cpu.resize(PROFILER_HISTORY_FRAMES);
+	gpu.resize(PROFILER_HISTORY_FRAMES);
+	for (uint32_t i = 0; i < PROFILER_HISTORY_FRAMES; i++) {
+		cpu[i] = cpuFrameTimes[(historyIndex + i) % PROFILER_HISTORY_FRAMES];
+		gpu[i] = gpuFrameTimes[(historyIndex + i) % PROFILER_HISTORY_FRAMES];
+	}
+}
+
+void Profiler::LastFrameEvents(std::vector<ProfileEvent>& events)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	events = lastEvents;
+}
+
+void Profiler::StartCapture()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	capturing = true;
+	captureBegin = Now();
+	captured.clear();
+}
+
+bool Profiler::Capturing()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return capturing;
+}
+
+void Profiler::StopCapture(const std::string& filename)
+{
+	std::vector<ProfileEvent> events;
+	uint64_t cpuBase;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		capturing = false;
+		events.swap(captured);
+		cpuBase = captureBegin;
+	}
+
+	std::ofstream file(filename);
+	if (!file.is_open()) {
+		throw std::runtime_error("failed to open " + filename);
+	}
+
+	uint64_t gpuBase = std::numeric_limits<uint64_t>::max();
+	for (const ProfileEvent& event : events) {
+		if (event.track == ProfileTrack::Gpu) {
+			gpuBase = std::min(gpuBase, event.begin);
+		}
+	}
+
+	file << "{\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}}";
+
+	for (const ProfileEvent& event : events) {
+		bool gpu = event.track == ProfileTrack::Gpu;
+		uint64_t base = gpu ? gpuBase : cpuBase;
+		// Events that started before the capture are clamped to its start.
+		uint64_t begin = std::max(event.begin, base);
+
+		file << ",\n{\"name\":\"" << escapeJson(event.name) << "\",\"ph\":\"X\",\"pid\":" << (gpu ? 1 : 0)
+			 << ",\"tid\":" << event.thread << ",\"ts\":" << (begin - base) / 1e3
+			 << ",\"dur\":" << (event.end > begin ? event.end - begin : 0) / 1e3 << "}";
+	}
+
+	file << "\n]}\n";
+}
+
+ProfileScope::ProfileScope(const char* name)
+	: name(name), begin(Profiler::Now())
+{
+}
+
+ProfileScope::~ProfileScope()
+{
+	Profiler::Get().AddEvent(ProfileEvent{
+		.name = name,
+		.track = ProfileTrack::Cpu,
+		.thread = Profiler::ThreadIndex(),
+		.begin = begin,
+		.end = Profiler::Now(),
+	});
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Frames of timing history kept for the frame graph.
+const uint32_t PROFILER_HISTORY_FRAMES = 256;
+
+enum class ProfileTrack
+{
+	Cpu,
+	Gpu,
+};
+
+// A timed region. Names are not copied: pass string literals or strings that outlive the profiler.
+struct ProfileEvent
+{
+	const char* name;
+	ProfileTrack track;
+	// Index of the recording thread for CPU events, 0 for GPU events.
+	uint32_t thread;
+	// Nanoseconds; CPU events use the steady clock, GPU events the device's timestamp clock.
+	uint64_t begin;
+	uint64_t end;
+};
+
+// Collects CPU scopes from any thread and GPU regions resolved by the RHI, frame by frame. Keeps a rolling
+// history of frame times for the frame graph and, while capturing, every event for a Chrome trace
+// (chrome://tracing or ui.perfetto.dev).
+class Profiler
+{
+public:
+	static Profiler& Get();
+
+	// Closes the current frame and starts the next; call once per frame, before anything is timed.
+	void BeginFrame();
+
+	void AddEvent(const ProfileEvent& event);
+
+	// CPU frame time and GPU time of the last PROFILER_HISTORY_FRAMES frames in milliseconds, oldest first.
+	// The GPU time of a frame is the span of the GPU events added during it, which the RHI reports a few
+	// frames late.
+	void FrameTimes(std::vector<float>& cpu, std::vector<float>& gpu);
+
+	// Events added during the last completed frame.
+	void LastFrameEvents(std::vector<ProfileEvent>& events);
+
+	void StartCapture();
+
+	bool Capturing();
+
+	// Writes every event added since StartCapture as Chrome trace JSON and stops capturing. GPU events go to
+	// a track of their own whose clock is aligned to the start of the capture, not to the CPU events.
+	void StopCapture(const std::string& filename);
+
+	static uint64_t Now();
+
+	// Small stable index of the calling thread, for CPU events.
+	static uint32_t ThreadIndex();
+
+private:
+	Profiler();
+
+	std::mutex mutex;
+
+	uint64_t frameBegin;
+	std::vector<ProfileEvent> currentEvents;
+	std::vector<ProfileEvent> lastEvents;
+
+	float cpuFrameTimes[PROFILER_HISTORY_FRAMES];
+	float gpuFrameTimes[PROFILER_HISTORY_FRAMES];
+	// Slot the next frame is written to, which holds the oldest one.
+	uint32_t historyIndex;
+
+	bool capturing;
+	uint64_t captureBegin;
+	std::vector<ProfileEvent> captured;
+};
+
+// Adds a CPU event covering its lifetime.
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* name);
+
+	~ProfileScope();
+
+	ProfileScope(const ProfileScope&) = delete;
+
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char* name;
+	uint64_t begin;
+};
+
+#define MUFFIN_PROFILE_CONCAT_IMPL(a, b) a##b
+#define MUFFIN_PROFILE_CONCAT(a, b) MUFFIN_PROFILE_CONCAT_IMPL(a, b)
+
+// Times the rest of the enclosing block. Compiles to nothing unless MUFFIN_PROFILING is defined.
+#ifdef MUFFIN_PROFILING
+#define MUFFIN_PROFILE_SCOPE(name) ProfileScope MUFFIN_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define MUFFIN_PROFILE_SCOPE(name)
+#endif
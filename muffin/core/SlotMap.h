@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Stable reference to a SlotMap element. A handle goes stale when its element is removed: the slot's
+// generation is bumped on removal, so stale handles never resolve to whatever reuses the slot.
+struct SlotHandle
+{
+	uint32_t index{ UINT32_MAX };
+	uint32_t generation{ 0 };
+
+	bool operator==(const SlotHandle& other) const = default;
+};
+
+// Values are kept packed in a dense array for cache-friendly iteration; handles go through a slot
+// table into it. Insert and Remove are O(1), and Remove swaps the last value into the hole.
+template <typename T>
+class SlotMap
+{
+public:
+	SlotHandle Insert(T value)
+	{
+		uint32_t slot;
+		if (freeList != UINT32_MAX) {
+			slot = freeList;
+			freeList = slots[slot].dense;
+		} else {
+			slot = slots.size();
+			slots.push_back(Slot{ .dense = 0, .generation = 0 });
+		}
+
+		slots[slot].dense = values.size();
+		values.push_back(std::move(value));
+		denseToSlot.push_back(slot);
+
+		return SlotHandle{ .index = slot, .generation = slots[slot].generation };
+	}
+
+	bool Remove(SlotHandle handle)
+	{
+		if (!Contains(handle)) {
+			return false;
+		}
+
+		uint32_t dense = slots[handle.index].dense;
+		uint32_t last = values.size() - 1;
+		if (dense != last) {
+			values[dense] = std::move(values[last]);
+			denseToSlot[dense] = denseToSlot[last];
+			slots[denseToSlot[dense]].dense = dense;
+		}
+		values.pop_back();
+		denseToSlot.pop_back();
+
+		// Free slots are chained through their dense index.
+		slots[handle.index].generation++;
+		slots[handle.index].dense = freeList;
+		freeList = handle.index;
+		return true;
+	}
+
+	bool Contains(SlotHandle handle) const
+	{
+		return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+	}
+
+	// Returns nullptr for stale handles.
+	T* Get(SlotHandle handle)
+	{
+		return Contains(handle) ? &values[slots[handle.index].dense] : nullptr;
+	}
+
+	const T* Get(SlotHandle handle) const
+	{
+		return Contains(handle) ? &values[slots[handle.index].dense] : nullptr;
+	}
+
+	// Value in a live slot, without the generation check.
+	T& AtSlot(uint32_t slot)
+	{
+		return values[slots[slot].dense];
+	}
+
+	SlotHandle HandleAt(size_t dense) const
+	{
+		uint32_t slot = denseToSlot[dense];
+		return SlotHandle{ .index = slot, .generation = slots[slot].generation };
+	}
+
+	const std::vector<T>& Values() const
+	{
+		return values;
+	}
+
+	size_t Size() const
+	{
+		return values.size();
+	}
+
+private:
+	struct Slot
+	{
+		uint32_t dense;
+		uint32_t generation;
+	};
+
+	std::vector<T> values;
+	std::vector<uint32_t> denseToSlot;
+	std::vector<Slot> slots;
+	uint32_t freeList{ UINT32_MAX };
+};
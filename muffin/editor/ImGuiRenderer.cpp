@@ -72,10 +72,10 @@ void ImGuiRenderer::Render(RHICommandListRef commandList)
 	uint32_t colBufferSize = drawData->TotalVtxCount * sizeof(ImU32);
 	uint32_t indexBufferSize = drawData->TotalIdxCount * sizeof(ImDrawIdx);
 
-	std::vector<ImVec2> pos;
-	std::vector<ImVec2> uv;
-	std::vector<ImU32> col;
-	std::vector<ImDrawIdx> index;
+	pos.clear();
+	uv.clear();
+	col.clear();
+	index.clear();
 
 	for (int32_t cmdListIndex = 0; cmdListIndex < drawData->CmdListsCount; ++cmdListIndex) {
 		const ImDrawList* cmdList = drawData->CmdLists[cmdListIndex];
@@ -94,41 +94,25 @@ void ImGuiRenderer::Render(RHICommandListRef commandList)
 		return;
 	}
 
-	RHIBufferRef posBuffer = driver->CreateBuffer(posBufferSize, BufferInfo{ .usage = BufferUsage::Vertex });
-	posBuffer->Write(pos.data(), posBufferSize);
-
-	RHIBufferRef uvBuffer = driver->CreateBuffer(uvBufferSize, BufferInfo{ .usage = BufferUsage::Vertex });
-	uvBuffer->Write(uv.data(), uvBufferSize);
-
-	RHIBufferRef colBuffer = driver->CreateBuffer(colBufferSize, BufferInfo{ .usage = BufferUsage::Vertex });
-	colBuffer->Write(col.data(), colBufferSize);
-
-	RHIBufferRef indexBuffer = driver->CreateBuffer(indexBufferSize, BufferInfo{ .usage = BufferUsage::Index });
-	indexBuffer->Write(index.data(), indexBufferSize);
-
-	struct UBO
+	struct PushConstants
 	{
 		glm::vec2 scale;
 		glm::vec2 translate;
 	};
 
-	RHIBufferRef uboBuffer = driver->CreateBuffer(sizeof(UBO), BufferInfo{ .usage = BufferUsage::Uniform });
-
-	UBO ubo;
-	ubo.scale = glm::vec2(2.0f / io.DisplaySize.x, 2.0f / io.DisplaySize.y);
-	ubo.translate = glm::vec2(-1.f);
-
-	uboBuffer->Write(&ubo, sizeof(ubo));
+	PushConstants pc;
+	pc.scale = glm::vec2(2.0f / io.DisplaySize.x, 2.0f / io.DisplaySize.y);
+	pc.translate = glm::vec2(-1.f);
 
 	commandList->BindPipeline(pipeline);
 	commandList->SetViewport(0, 0, io.DisplaySize.x, io.DisplaySize.y);
-	commandList->BindVertexBuffer(posBuffer, 2);
-	commandList->BindVertexBuffer(uvBuffer, 0);
-	commandList->BindVertexBuffer(colBuffer, 1);
-	commandList->BindIndexBuffer(indexBuffer);
+	commandList->BindVertexData(pos.data(), posBufferSize, 2);
+	commandList->BindVertexData(uv.data(), uvBufferSize, 0);
+	commandList->BindVertexData(col.data(), colBufferSize, 1);
+	commandList->BindIndexData(index.data(), indexBufferSize);
 
 	commandList->BindTexture("fontSampler", fontTexture, fontSampler);
-	commandList->BindUniformBuffer("ubo", uboBuffer, sizeof(UBO));
+	commandList->PushConstants(0, sizeof(PushConstants), &pc);
 
 	int32_t globalIndexOffset = 0;
 	int32_t globalVertexOffset = 0;
@@ -21,4 +21,10 @@ private:
 	RHIGraphicsPipelineRef pipeline;
 	RHISamplerRef fontSampler;
 	RHITextureRef fontTexture;
+
+	// Vertex streams and indices of the current frame, kept to reuse their storage.
+	std::vector<ImVec2> pos;
+	std::vector<ImVec2> uv;
+	std::vector<ImU32> col;
+	std::vector<ImDrawIdx> index;
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "ProfilerWindow.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <imgui.h>
+#include <vector>
+
+static void drawGraph(const char* label, const std::vector<float>& times)
+{
+	float latest = times.back();
+	float peak = *std::max_element(times.begin(), times.end());
+
+	char overlay[64];
+	snprintf(overlay, sizeof(overlay), "%.2f ms (max %.2f)", latest, peak);
+	ImGui::PlotLines(label, times.data(), times.size(), 0, overlay, 0.f, std::max(peak, 1.f) * 1.1f, ImVec2(0, 60));
+}
+
+// Region tree of one track and thread: nested regions are indented under the ones containing them.
+static void drawEvents(std::vector<ProfileEvent>& events)
+{
+	std::sort(events.begin(), events.end(), [](const ProfileEvent& a, const ProfileEvent& b) {
+		if (a.track != b.track) {
+			return a.track < b.track;
+		}
+		if (a.thread != b.thread) {
+			return a.thread < b.thread;
+		}
+		return a.begin != b.begin ? a.begin < b.begin : a.end > b.end;
+	});
+
+	std::vector<uint64_t> enclosingEnds;
+	for (size_t i = 0; i < events.size(); i++) {
+		const ProfileEvent& event = events[i];
+		if (i == 0 || event.track != events[i - 1].track || event.thread != events[i - 1].thread) {
+			enclosingEnds.clear();
+			if (event.track == ProfileTrack::Gpu) {
+				ImGui::TextDisabled("GPU");
+			} else {
+				ImGui::TextDisabled("CPU thread %u", event.thread);
+			}
+		}
+
+		while (!enclosingEnds.empty() && enclosingEnds.back() <= event.begin) {
+			enclosingEnds.pop_back();
+		}
+		ImGui::Text("%*s%s: %.3f ms", int(enclosingEnds.size() * 2), "", event.name, (event.end - event.begin) / 1e6);
+		enclosingEnds.push_back(event.end);
+	}
+}
+
+void DrawProfilerWindow(Profiler& profiler, const std::string& traceFile)
+{
+	static std::vector<float> cpuTimes;
+	static std::vector<float> gpuTimes;
+	static std::vector<ProfileEvent> events;
+
+	ImGui::Begin("Profiler");
+
+	profiler.FrameTimes(cpuTimes, gpuTimes);
+	drawGraph("CPU frame", cpuTimes);
+	drawGraph("GPU frame", gpuTimes);
+
+	if (!profiler.Capturing()) {
+		if (ImGui::Button("Start trace capture")) {
+			profiler.StartCapture();
+		}
+	} else if (ImGui::Button(("Stop and save " + traceFile).c_str())) {
+		profiler.StopCapture(traceFile);
+	}
+
+	if (ImGui::CollapsingHeader("Last frame")) {
+		profiler.LastFrameEvents(events);
+		drawEvents(events);
+	}
+
+	ImGui::End();
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "muffin/core/Profiler.h"
+
+#include <string>
+
+// ImGui window with a rolling graph of CPU and GPU frame times, the regions of the last frame and
+// buttons to capture a Chrome trace into traceFile. Call between ImGui::NewFrame and ImGui::Render.
+void DrawProfilerWindow(Profiler& profiler, const std::string& traceFile = "trace.json");
@@ -0,0 +1,75 @@
+#include "RHIStatsWindow.h"
+
+#include <cinttypes>
+#include <imgui.h>
+
+static void drawCount(const char* label, uint64_t frame, uint64_t total)
+{
+	ImGui::Text("%-24s %10" PRIu64 " %14" PRIu64, label, frame, total);
+}
+
+static void drawBinds(const char* label, uint64_t frame, uint64_t frameSkipped, uint64_t total, uint64_t totalSkipped)
+{
+	ImGui::Text("%-24s %10" PRIu64 " %14" PRIu64, label, frame, total);
+	ImGui::TextDisabled("%-24s %10" PRIu64 " %14" PRIu64, "  skipped", frameSkipped, totalSkipped);
+}
+
+static void drawBytes(const char* label, uint64_t frame, uint64_t total)
+{
+	ImGui::Text("%-24s %7.2f MiB %11.2f MiB", label, frame / (1024.0 * 1024.0), total / (1024.0 * 1024.0));
+}
+
+void DrawRHIStatsWindow(RHIDriver& driver)
+{
+	RHIStats frame = driver.FrameStats();
+	RHIStats total = driver.TotalStats();
+	const CommandListStats& frameCommands = frame.commands;
+	const CommandListStats& totalCommands = total.commands;
+
+	ImGui::Begin("RHI stats");
+
+	ImGui::TextDisabled("%-24s %10s %14s", "", "last frame", "total");
+
+	if (ImGui::CollapsingHeader("Commands")) {
+		drawCount("Draws", frameCommands.draws, totalCommands.draws);
+		drawCount("Instances", frameCommands.instances, totalCommands.instances);
+		drawCount("Triangles", frameCommands.triangles, totalCommands.triangles);
+		drawCount("Indirect draws", frameCommands.indirectDraws, totalCommands.indirectDraws);
+		drawCount("Dispatches", frameCommands.dispatches, totalCommands.dispatches);
+		drawBinds("Pipeline binds", frameCommands.pipelineBinds, frameCommands.pipelineBindsSkipped,
+			totalCommands.pipelineBinds, totalCommands.pipelineBindsSkipped);
+		drawBinds("Vertex buffer binds", frameCommands.vertexBufferBinds, frameCommands.vertexBufferBindsSkipped,
+			totalCommands.vertexBufferBinds, totalCommands.vertexBufferBindsSkipped);
+		drawBinds("Index buffer binds", frameCommands.indexBufferBinds, frameCommands.indexBufferBindsSkipped,
+			totalCommands.indexBufferBinds, totalCommands.indexBufferBindsSkipped);
+		drawBinds("Descriptor set binds", frameCommands.descriptorSetBinds, frameCommands.descriptorSetBindsSkipped,
+			totalCommands.descriptorSetBinds, totalCommands.descriptorSetBindsSkipped);
+		drawBinds("Viewports", frameCommands.viewportSets, frameCommands.viewportSetsSkipped,
+			totalCommands.viewportSets, totalCommands.viewportSetsSkipped);
+		drawBinds("Scissors", frameCommands.scissorSets, frameCommands.scissorSetsSkipped,
+			totalCommands.scissorSets, totalCommands.scissorSetsSkipped);
+		drawCount("Push constants", frameCommands.pushConstants, totalCommands.pushConstants);
+	}
+
+	if (ImGui::CollapsingHeader("Submission")) {
+		drawCount("Submits", frame.submits, total.submits);
+		drawCount("Fence waits", frame.fenceWaits, total.fenceWaits);
+		ImGui::Text("%-24s %7.3f ms %11.1f ms", "Fence wait time", frame.fenceWaitNs / 1e6, total.fenceWaitNs / 1e6);
+		drawCount("Descriptor sets", frame.descriptorSetsAllocated, total.descriptorSetsAllocated);
+	}
+
+	if (ImGui::CollapsingHeader("Memory")) {
+		drawCount("Memory allocations", frame.memoryAllocations, total.memoryAllocations);
+		drawCount("Memory frees", frame.memoryFrees, total.memoryFrees);
+		drawCount("Buffers created", frame.buffersCreated, total.buffersCreated);
+		drawCount("Buffers destroyed", frame.buffersDestroyed, total.buffersDestroyed);
+		drawBytes("Buffer bytes created", frame.bufferBytesCreated, total.bufferBytesCreated);
+		drawBytes("Buffer bytes freed", frame.bufferBytesFreed, total.bufferBytesFreed);
+		drawCount("Textures created", frame.texturesCreated, total.texturesCreated);
+		drawCount("Textures destroyed", frame.texturesDestroyed, total.texturesDestroyed);
+		drawBytes("Texture bytes created", frame.textureBytesCreated, total.textureBytesCreated);
+		drawBytes("Texture bytes freed", frame.textureBytesFreed, total.textureBytesFreed);
+	}
+
+	ImGui::End();
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "muffin/graphics/rhi/RHI.h"
+
+// ImGui window with the driver's counters for the last frame next to the totals since startup.
+// Call between ImGui::NewFrame and ImGui::Render.
+void DrawRHIStatsWindow(RHIDriver& driver);
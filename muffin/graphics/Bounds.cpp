@@ -0,0 +1,103 @@
+#include "Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+glm::vec3 AABB::Center() const
+{
+	return (min + max) * 0.5f;
+}
+
+glm::vec3 AABB::Extents() const
+{
+	return (max - min) * 0.5f;
+}
+
+float AABB::SurfaceArea() const
+{
+	glm::vec3 d = max - min;
+	return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+bool AABB::Contains(const AABB& other) const
+{
+	return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z && other.max.x <= max.x &&
+		other.max.y <= max.y && other.max.z <= max.z;
+}
+
+AABB AABB::Transform(const glm::mat4& transform) const
+{
+	glm::vec3 center = glm::vec3(transform * glm::vec4(Center(), 1.f));
+	glm::vec3 extents = Extents();
+
+	glm::vec3 worldExtents(0.f);
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			worldExtents[i] += std::abs(transform[j][i]) * extents[j];
+		}
+	}
+
+	return AABB{ .min = center - worldExtents, .max = center + worldExtents };
+}
+
+AABB AABB::Expand(float margin) const
+{
+	return AABB{ .min = min - glm::vec3(margin), .max = max + glm::vec3(margin) };
+}
+
+float AABB::Distance2(const glm::vec3& point) const
+{
+	glm::vec3 d = glm::max(glm::max(min - point, point - max), glm::vec3(0.f));
+	return glm::dot(d, d);
+}
+
+float AABB::RayDistance(const glm::vec3& origin, const glm::vec3& invDirection, float maxDistance) const
+{
+	float tMin = 0.f;
+	float tMax = maxDistance;
+	for (int i = 0; i < 3; i++) {
+		float t1 = (min[i] - origin[i]) * invDirection[i];
+		float t2 = (max[i] - origin[i]) * invDirection[i];
+		tMin = std::max(tMin, std::min(t1, t2));
+		tMax = std::min(tMax, std::max(t1, t2));
+	}
+	return tMin <= tMax ? tMin : -1.f;
+}
+
+AABB AABB::Merge(const AABB& a, const AABB& b)
+{
+	return AABB{ .min = glm::min(a.min, b.min), .max = glm::max(a.max, b.max) };
+}
+
+BoundingSphere BoundingSphere::Transform(const glm::mat4& transform) const
+{
+	float scale = std::max({ glm::dot(transform[0], transform[0]), glm::dot(transform[1], transform[1]),
+		glm::dot(transform[2], transform[2]) });
+
+	return BoundingSphere{ .center = glm::vec3(transform * glm::vec4(center, 1.f)), .radius = radius * std::sqrt(scale) };
+}
+
+Bounds Bounds::FromPoints(const std::vector<glm::vec3>& points)
+{
+	Bounds bounds;
+	if (points.empty()) {
+		return bounds;
+	}
+
+	bounds.box.min = points[0];
+	bounds.box.max = points[0];
+	for (const glm::vec3& p : points) {
+		bounds.box.min = glm::min(bounds.box.min, p);
+		bounds.box.max = glm::max(bounds.box.max, p);
+	}
+
+	bounds.sphere.center = bounds.box.Center();
+	float radius2 = 0.f;
+	for (const glm::vec3& p : points) {
+		glm::vec3 d = p - bounds.sphere.center;
+		radius2 = std::max(radius2, glm::dot(d, d));
+	}
+	bounds.sphere.radius = std::sqrt(radius2);
+
+	return bounds;
+}
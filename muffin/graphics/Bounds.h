@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+struct AABB
+{
+	glm::vec3 min{ 0.f };
+	glm::vec3 max{ 0.f };
+
+	glm::vec3 Center() const;
+
+	glm::vec3 Extents() const;
+
+	// Sum of the face areas; the cost metric used when building bounding volume trees.
+	float SurfaceArea() const;
+
+	bool Contains(const AABB& other) const;
+
+	// Bounds of the box after transform (Arvo's method), exact for the transformed corners.
+	AABB Transform(const glm::mat4& transform) const;
+
+	AABB Expand(float margin) const;
+
+	// Squared distance from point to the box, zero inside it.
+	float Distance2(const glm::vec3& point) const;
+
+	// Slab test against a ray given by its inverse direction; returns the entry distance, or a negative value
+	// if the ray misses the box within maxDistance.
+	float RayDistance(const glm::vec3& origin, const glm::vec3& invDirection, float maxDistance) const;
+
+	static AABB Merge(const AABB& a, const AABB& b);
+};
+
+struct BoundingSphere
+{
+	glm::vec3 center{ 0.f };
+	float radius{ 0.f };
+
+	// Bounds of the sphere after transform, scaled by the largest axis scale so it stays conservative.
+	BoundingSphere Transform(const glm::mat4& transform) const;
+};
+
+struct Bounds
+{
+	AABB box;
+	BoundingSphere sphere;
+
+	// Sphere is centred on the box rather than minimal, which is tight enough for culling and cheap to build.
+	static Bounds FromPoints(const std::vector<glm::vec3>& points);
+};
@@ -0,0 +1,60 @@
+#include "Camera.h"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include <glm/gtc/matrix_transform.hpp>
+
+Camera::Camera()
+	: position(0.f), view(1.f), projection(1.f), viewProjection(1.f)
+{
+}
+
+void Camera::LookAt(const glm::vec3& newPosition, const glm::vec3& target, const glm::vec3& up)
+{
+	position = newPosition;
+	view = glm::lookAt(position, target, up);
+	updateViewProjection();
+}
+
+void Camera::SetPerspective(float fovY, float aspect, float nearPlane, float farPlane)
+{
+	projection = glm::perspective(fovY, aspect, nearPlane, farPlane);
+	projection[1][1] *= -1;
+	updateViewProjection();
+}
+
+void Camera::updateViewProjection()
+{
+	viewProjection = projection * view;
+}
+
+const glm::mat4& Camera::View() const
+{
+	return view;
+}
+
+const glm::mat4& Camera::Projection() const
+{
+	return projection;
+}
+
+const glm::mat4& Camera::ViewProjection() const
+{
+	return viewProjection;
+}
+
+const glm::vec3& Camera::Position() const
+{
+	return position;
+}
+
+ViewUniforms Camera::Uniforms() const
+{
+	return ViewUniforms{
+		.view = view,
+		.proj = projection,
+		.viewProj = viewProjection,
+		.position = glm::vec4(position, 1.f),
+	};
+}
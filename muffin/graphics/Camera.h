@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Per-view constants, bound once per pass as "camera" (set 0). Layout matches shader.vert (std140).
+struct ViewUniforms
+{
+	glm::mat4 view;
+	glm::mat4 proj;
+	glm::mat4 viewProj;
+	glm::vec4 position;
+};
+
+class Camera
+{
+public:
+	Camera();
+
+	void LookAt(const glm::vec3& position, const glm::vec3& target, const glm::vec3& up);
+
+	// Vulkan clip space: the projection is flipped in Y and maps depth to [0, 1].
+	void SetPerspective(float fovY, float aspect, float nearPlane, float farPlane);
+
+	const glm::mat4& View() const;
+
+	const glm::mat4& Projection() const;
+
+	const glm::mat4& ViewProjection() const;
+
+	const glm::vec3& Position() const;
+
+	ViewUniforms Uniforms() const;
+
+private:
+	void updateViewProjection();
+
+	glm::vec3 position;
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 viewProjection;
+};
@@ -0,0 +1,194 @@
+#include "Culling.h"
+
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+Frustum Frustum::FromMatrix(const glm::mat4& m)
+{
+	// Rows of the matrix; glm stores columns.
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++) {
+		rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+	}
+
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0];
+	frustum.planes[1] = rows[3] - rows[0];
+	frustum.planes[2] = rows[3] + rows[1];
+	frustum.planes[3] = rows[3] - rows[1];
+	frustum.planes[4] = rows[3] + rows[2];
+	frustum.planes[5] = rows[3] - rows[2];
+
+	for (glm::vec4& plane : frustum.planes) {
+		plane = plane / glm::length(glm::vec3(plane));
+	}
+
+	return frustum;
+}
+
+FrustumTest Frustum::Test(const AABB& box) const
+{
+	glm::vec3 center = box.Center();
+	glm::vec3 extents = box.Extents();
+
+	FrustumTest result = FrustumTest::Inside;
+	for (const glm::vec4& plane : planes) {
+		glm::vec3 normal(plane);
+		float distance = glm::dot(normal, center) + plane.w;
+		float radius = glm::dot(glm::abs(normal), extents);
+
+		if (distance + radius < 0.f) {
+			return FrustumTest::Outside;
+		}
+		if (distance - radius < 0.f) {
+			result = FrustumTest::Intersects;
+		}
+	}
+	return result;
+}
+
+size_t BoundingSphereArray::Size() const
+{
+	return x.size();
+}
+
+void BoundingSphereArray::Resize(size_t size)
+{
+	x.resize(size);
+	y.resize(size);
+	z.resize(size);
+	radius.resize(size);
+}
+
+void BoundingSphereArray::Set(size_t i, const BoundingSphere& sphere)
+{
+	x[i] = sphere.center.x;
+	y[i] = sphere.center.y;
+	z[i] = sphere.center.z;
+	radius[i] = sphere.radius;
+}
+
+static size_t cullScalar(const Frustum& frustum, const BoundingSphereArray& spheres, size_t begin,
+	std::vector<uint32_t>& visible)
+{
+	size_t added = 0;
+	for (size_t i = begin; i < spheres.Size(); i++) {
+		bool inside = true;
+		for (const glm::vec4& p : frustum.planes) {
+			if (p.x * spheres.x[i] + p.y * spheres.y[i] + p.z * spheres.z[i] + p.w < -spheres.radius[i]) {
+				inside = false;
+				break;
+			}
+		}
+		if (inside) {
+			visible.push_back(i);
+			added++;
+		}
+	}
+	return added;
+}
+
+size_t CullSpheresScalar(const Frustum& frustum, const BoundingSphereArray& spheres, std::vector<uint32_t>& visible)
+{
+	return cullScalar(frustum, spheres, 0, visible);
+}
+
+#if defined(__AVX__)
+
+size_t CullSpheres(const Frustum& frustum, const BoundingSphereArray& spheres, std::vector<uint32_t>& visible)
+{
+	__m256 planes[6][4];
+	for (int p = 0; p < 6; p++) {
+		for (int c = 0; c < 4; c++) {
+			planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+		}
+	}
+
+	size_t count = spheres.Size();
+	size_t start = visible.size();
+	visible.resize(start + count);
+	uint32_t* out = visible.data() + start;
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 x = _mm256_loadu_ps(&spheres.x[i]);
+		__m256 y = _mm256_loadu_ps(&spheres.y[i]);
+		__m256 z = _mm256_loadu_ps(&spheres.z[i]);
+		__m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+
+		__m256 outside = _mm256_setzero_ps();
+		for (int p = 0; p < 6; p++) {
+			__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planes[p][0], x), _mm256_mul_ps(planes[p][1], y)),
+				_mm256_add_ps(_mm256_mul_ps(planes[p][2], z), planes[p][3]));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, negRadius, _CMP_LT_OQ));
+		}
+
+		uint32_t mask = ~_mm256_movemask_ps(outside) & 0xff;
+		while (mask) {
+			int bit = __builtin_ctz(mask);
+			*out++ = i + bit;
+			mask &= mask - 1;
+		}
+	}
+
+	visible.resize(out - visible.data());
+	size_t added = visible.size() - start;
+	return added + cullScalar(frustum, spheres, i, visible);
+}
+
+#elif defined(__SSE2__)
+
+size_t CullSpheres(const Frustum& frustum, const BoundingSphereArray& spheres, std::vector<uint32_t>& visible)
+{
+	__m128 planes[6][4];
+	for (int p = 0; p < 6; p++) {
+		for (int c = 0; c < 4; c++) {
+			planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+		}
+	}
+
+	size_t count = spheres.Size();
+	size_t start = visible.size();
+	visible.resize(start + count);
+	uint32_t* out = visible.data() + start;
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 x = _mm_loadu_ps(&spheres.x[i]);
+		__m128 y = _mm_loadu_ps(&spheres.y[i]);
+		__m128 z = _mm_loadu_ps(&spheres.z[i]);
+		__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+
+		__m128 outside = _mm_setzero_ps();
+		for (int p = 0; p < 6; p++) {
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes[p][0], x), _mm_mul_ps(planes[p][1], y)),
+				_mm_add_ps(_mm_mul_ps(planes[p][2], z), planes[p][3]));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(d, negRadius));
+		}
+
+		uint32_t mask = ~_mm_movemask_ps(outside) & 0xf;
+		while (mask) {
+			int bit = __builtin_ctz(mask);
+			*out++ = i + bit;
+			mask &= mask - 1;
+		}
+	}
+
+	visible.resize(out - visible.data());
+	size_t added = visible.size() - start;
+	return added + cullScalar(frustum, spheres, i, visible);
+}
+
+#else
+
+size_t CullSpheres(const Frustum& frustum, const BoundingSphereArray& spheres, std::vector<uint32_t>& visible)
+{
+	return cullScalar(frustum, spheres, 0, visible);
+}
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Bounds.h"
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+enum class FrustumTest
+{
+	Outside,
+	Intersects,
+	Inside
+};
+
+// Six inward-facing planes (xyz = normal, w = distance) extracted from a view-projection matrix:
+// left, right, bottom, top, near, far. The near plane is taken at clip z = -w, which is exact for
+// a -1..1 depth range and slightly conservative for 0..1.
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	FrustumTest Test(const AABB& box) const;
+
+	static Frustum FromMatrix(const glm::mat4& viewProjection);
+};
+
+// World-space bounding spheres in structure-of-arrays form, so the culling loop can load
+// several spheres per register instead of gathering fields from scattered objects.
+struct BoundingSphereArray
+{
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> radius;
+
+	size_t Size() const;
+
+	void Resize(size_t size);
+
+	void Set(size_t i, const BoundingSphere& sphere);
+};
+
+// Appends the indices of spheres that intersect the frustum to visible and returns how many were added.
+// Uses AVX or SSE when the target supports them.
+size_t CullSpheres(const Frustum& frustum, const BoundingSphereArray& spheres, std::vector<uint32_t>& visible);
+
+// Reference implementation, one sphere at a time.
+size_t CullSpheresScalar(const Frustum& frustum, const BoundingSphereArray& spheres, std::vector<uint32_t>& visible);
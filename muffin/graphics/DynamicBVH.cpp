@@ -0,0 +1,415 @@
+#include "DynamicBVH.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+bool DynamicBVH::Node::IsLeaf() const
+{
+	return left == BVH_NULL_NODE;
+}
+
+int32_t DynamicBVH::allocateNode()
+{
+	if (freeList == BVH_NULL_NODE) {
+		nodes.push_back(Node{});
+		freeList = nodes.size() - 1;
+		nodes[freeList].parent = BVH_NULL_NODE;
+	}
+
+	int32_t node = freeList;
+	freeList = nodes[node].parent;
+
+	nodes[node] = Node{ .parent = BVH_NULL_NODE, .left = BVH_NULL_NODE, .right = BVH_NULL_NODE, .height = 0, .userData = 0 };
+	return node;
+}
+
+void DynamicBVH::freeNode(int32_t node)
+{
+	// Free nodes are chained through their parent index.
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	freeList = node;
+}
+
+int32_t DynamicBVH::Insert(const AABB& box, uint32_t userData)
+{
+	int32_t leaf = allocateNode();
+	nodes[leaf].box = box.Expand(BVH_FAT_MARGIN);
+	nodes[leaf].userData = userData;
+	insertLeaf(leaf);
+	return leaf;
+}
+
+void DynamicBVH::Remove(int32_t proxy)
+{
+	if (proxy < 0 || proxy >= (int32_t)nodes.size() || !nodes[proxy].IsLeaf() || nodes[proxy].height < 0) {
+		throw std::runtime_error("invalid bvh proxy");
+	}
+	removeLeaf(proxy);
+	freeNode(proxy);
+}
+
+bool DynamicBVH::Move(int32_t proxy, const AABB& box)
+{
+	if (nodes[proxy].box.Contains(box)) {
+		return false;
+	}
+
+	removeLeaf(proxy);
+	nodes[proxy].box = box.Expand(BVH_FAT_MARGIN);
+	insertLeaf(proxy);
+	return true;
+}
+
+uint32_t DynamicBVH::UserData(int32_t proxy) const
+{
+	return nodes[proxy].userData;
+}
+
+const AABB& DynamicBVH::FatBounds(int32_t proxy) const
+{
+	return nodes[proxy].box;
+}
+
+int32_t DynamicBVH::Height() const
+{
+	return root == BVH_NULL_NODE ? 0 : nodes[root].height;
+}
+
+size_t DynamicBVH::Validate() const
+{
+	if (root == BVH_NULL_NODE) {
+		return 0;
+	}
+	if (nodes[root].parent != BVH_NULL_NODE) {
+		throw std::runtime_error("bvh root has a parent");
+	}
+
+	size_t leaves = 0;
+	std::vector<int32_t> stack{ root };
+
+	while (!stack.empty()) {
+		int32_t index = stack.back();
+		stack.pop_back();
+
+		const Node& node = nodes[index];
+		if (node.IsLeaf()) {
+			if (node.right != BVH_NULL_NODE || node.height != 0) {
+				throw std::runtime_error("bvh leaf is malformed");
+			}
+			leaves++;
+			continue;
+		}
+
+		const Node& left = nodes[node.left];
+		const Node& right = nodes[node.right];
+		if (left.parent != index || right.parent != index) {
+			throw std::runtime_error("bvh child does not point back to its parent");
+		}
+		if (node.height != 1 + std::max(left.height, right.height)) {
+			throw std::runtime_error("bvh node height is stale");
+		}
+		if (!node.box.Contains(left.box) || !node.box.Contains(right.box)) {
+			throw std::runtime_error("bvh node does not enclose its children");
+		}
+
+		stack.push_back(node.left);
+		stack.push_back(node.right);
+	}
+	return leaves;
+}
+
+void DynamicBVH::insertLeaf(int32_t leaf)
+{
+	if (root == BVH_NULL_NODE) {
+		root = leaf;
+		nodes[leaf].parent = BVH_NULL_NODE;
+		return;
+	}
+
+	AABB leafBox = nodes[leaf].box;
+
+	// Walk down towards the cheapest sibling: stop where pairing with the current node costs less than descending.
+	int32_t index = root;
+	while (!nodes[index].IsLeaf()) {
+		const Node& node = nodes[index];
+
+		float area = node.box.SurfaceArea();
+		float combinedArea = AABB::Merge(node.box, leafBox).SurfaceArea();
+		float cost = 2.f * combinedArea;
+		float inheritance = 2.f * (combinedArea - area);
+
+		auto descendCost = [&](int32_t child) {
+			const Node& c = nodes[child];
+			float merged = AABB::Merge(c.box, leafBox).SurfaceArea();
+			return (c.IsLeaf() ? merged : merged - c.box.SurfaceArea()) + inheritance;
+		};
+
+		float leftCost = descendCost(node.left);
+		float rightCost = descendCost(node.right);
+
+		if (cost < leftCost && cost < rightCost) {
+			break;
+		}
+		index = leftCost < rightCost ? node.left : node.right;
+	}
+
+	int32_t sibling = index;
+	int32_t oldParent = nodes[sibling].parent;
+	int32_t newParent = allocateNode();
+
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].box = AABB::Merge(leafBox, nodes[sibling].box);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].left = sibling;
+	nodes[newParent].right = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent == BVH_NULL_NODE) {
+		root = newParent;
+	} else {
+		replaceChild(oldParent, sibling, newParent);
+	}
+
+	refit(nodes[leaf].parent);
+}
+
+void DynamicBVH::removeLeaf(int32_t leaf)
+{
+	if (leaf == root) {
+		root = BVH_NULL_NODE;
+		return;
+	}
+
+	int32_t parent = nodes[leaf].parent;
+	int32_t grandParent = nodes[parent].parent;
+	int32_t sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+	nodes[sibling].parent = grandParent;
+	freeNode(parent);
+
+	if (grandParent == BVH_NULL_NODE) {
+		root = sibling;
+	} else {
+		replaceChild(grandParent, parent, sibling);
+		refit(grandParent);
+	}
+}
+
+void DynamicBVH::replaceChild(int32_t parent, int32_t oldChild, int32_t newChild)
+{
+	if (nodes[parent].left == oldChild) {
+		nodes[parent].left = newChild;
+	} else {
+		nodes[parent].right = newChild;
+	}
+}
+
+void DynamicBVH::refit(int32_t index)
+{
+	while (index != BVH_NULL_NODE) {
+		index = balance(index);
+
+		Node& node = nodes[index];
+		node.height = 1 + std::max(nodes[node.left].height, nodes[node.right].height);
+		node.box = AABB::Merge(nodes[node.left].box, nodes[node.right].box);
+
+		index = node.parent;
+	}
+}
+
+// Rotates the taller child of a up when the subtree heights differ by more than one; returns the new subtree root.
+int32_t DynamicBVH::balance(int32_t a)
+{
+	if (nodes[a].IsLeaf() || nodes[a].height < 2) {
+		return a;
+	}
+
+	int32_t b = nodes[a].left;
+	int32_t c = nodes[a].right;
+	int32_t difference = nodes[c].height - nodes[b].height;
+
+	if (difference > 1) {
+		int32_t f = nodes[c].left;
+		int32_t g = nodes[c].right;
+
+		nodes[c].left = a;
+		nodes[c].parent = nodes[a].parent;
+		nodes[a].parent = c;
+
+		if (nodes[c].parent == BVH_NULL_NODE) {
+			root = c;
+		} else {
+			replaceChild(nodes[c].parent, a, c);
+		}
+
+		// The taller grandchild stays with c, the other one replaces c under a.
+		int32_t keep = nodes[f].height > nodes[g].height ? f : g;
+		int32_t move = keep == f ? g : f;
+
+		nodes[c].right = keep;
+		nodes[a].right = move;
+		nodes[move].parent = a;
+
+		nodes[a].box = AABB::Merge(nodes[b].box, nodes[move].box);
+		nodes[a].height = 1 + std::max(nodes[b].height, nodes[move].height);
+		nodes[c].box = AABB::Merge(nodes[a].box, nodes[keep].box);
+		nodes[c].height = 1 + std::max(nodes[a].height, nodes[keep].height);
+		return c;
+	}
+
+	if (difference < -1) {
+		int32_t d = nodes[b].left;
+		int32_t e = nodes[b].right;
+
+		nodes[b].left = a;
+		nodes[b].parent = nodes[a].parent;
+		nodes[a].parent = b;
+
+		if (nodes[b].parent == BVH_NULL_NODE) {
+			root = b;
+		} else {
+			replaceChild(nodes[b].parent, a, b);
+		}
+
+		int32_t keep = nodes[d].height > nodes[e].height ? d : e;
+		int32_t move = keep == d ? e : d;
+
+		nodes[b].right = keep;
+		nodes[a].left = move;
+		nodes[move].parent = a;
+
+		nodes[a].box = AABB::Merge(nodes[c].box, nodes[move].box);
+		nodes[a].height = 1 + std::max(nodes[c].height, nodes[move].height);
+		nodes[b].box = AABB::Merge(nodes[a].box, nodes[keep].box);
+		nodes[b].height = 1 + std::max(nodes[a].height, nodes[keep].height);
+		return b;
+	}
+
+	return a;
+}
+
+void DynamicBVH::QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& inside,
+	std::vector<uint32_t>& intersecting) const
+{
+	if (root == BVH_NULL_NODE) {
+		return;
+	}
+
+	// Each entry carries whether its parent was already fully inside, in which case no more plane tests are needed.
+	std::vector<std::pair<int32_t, bool>> stack;
+	stack.emplace_back(root, false);
+
+	while (!stack.empty()) {
+		auto [index, parentInside] = stack.back();
+		stack.pop_back();
+
+		const Node& node = nodes[index];
+		if (parentInside) {
+			if (node.IsLeaf()) {
+				inside.push_back(node.userData);
+			} else {
+				stack.emplace_back(node.right, true);
+				stack.emplace_back(node.left, true);
+			}
+			continue;
+		}
+
+		if (node.IsLeaf()) {
+			intersecting.push_back(node.userData);
+			continue;
+		}
+
+		FrustumTest test = frustum.Test(node.box);
+		if (test != FrustumTest::Outside) {
+			stack.emplace_back(node.right, test == FrustumTest::Inside);
+			stack.emplace_back(node.left, test == FrustumTest::Inside);
+		}
+	}
+}
+
+bool DynamicBVH::RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+	const std::function<float(uint32_t, float)>& hitTest, uint32_t& hitUserData, float& hitDistance) const
+{
+	if (root == BVH_NULL_NODE) {
+		return false;
+	}
+
+	glm::vec3 invDirection(1.f / direction.x, 1.f / direction.y, 1.f / direction.z);
+	bool hit = false;
+
+	std::vector<int32_t> stack;
+	stack.push_back(root);
+
+	while (!stack.empty()) {
+		int32_t index = stack.back();
+		stack.pop_back();
+
+		const Node& node = nodes[index];
+		if (node.box.RayDistance(origin, invDirection, maxDistance) < 0.f) {
+			continue;
+		}
+
+		if (node.IsLeaf()) {
+			float distance = hitTest(node.userData, maxDistance);
+			if (distance >= 0.f && distance <= maxDistance) {
+				// Shrinking the ray prunes every subtree further away than this hit.
+				maxDistance = distance;
+				hitUserData = node.userData;
+				hitDistance = distance;
+				hit = true;
+			}
+		} else {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+
+	return hit;
+}
+
+bool DynamicBVH::Nearest(const glm::vec3& point, const std::function<float(uint32_t)>& distance2, uint32_t& nearestUserData) const
+{
+	if (root == BVH_NULL_NODE) {
+		return false;
+	}
+
+	float best = std::numeric_limits<float>::max();
+
+	std::vector<int32_t> stack;
+	stack.push_back(root);
+
+	while (!stack.empty()) {
+		int32_t index = stack.back();
+		stack.pop_back();
+
+		const Node& node = nodes[index];
+		if (node.box.Distance2(point) >= best) {
+			continue;
+		}
+
+		if (node.IsLeaf()) {
+			float d = distance2(node.userData);
+			if (d < best) {
+				best = d;
+				nearestUserData = node.userData;
+			}
+			continue;
+		}
+
+		// Visit the closer child first so best tightens early; it is pushed last.
+		float leftDistance = nodes[node.left].box.Distance2(point);
+		float rightDistance = nodes[node.right].box.Distance2(point);
+		if (leftDistance < rightDistance) {
+			stack.push_back(node.right);
+			stack.push_back(node.left);
+		} else {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+
+	return true;
+}
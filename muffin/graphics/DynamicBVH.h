@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Bounds.h"
+#include "Culling.h"
+
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <vector>
+
+const int32_t BVH_NULL_NODE = -1;
+
+// Leaves are stored enlarged by this much, so small movements do not touch the tree at all.
+const float BVH_FAT_MARGIN = 0.1f;
+
+// Incrementally updated AABB tree. Leaves are inserted next to the sibling that grows the tree's
+// surface area the least and the path back to the root is rebalanced with AVL-style rotations, so
+// queries stay logarithmic without ever rebuilding the whole tree.
+class DynamicBVH
+{
+public:
+	// Returns the proxy id of the new leaf; userData is handed back by queries.
+	int32_t Insert(const AABB& box, uint32_t userData);
+
+	void Remove(int32_t proxy);
+
+	// Returns true if box left the leaf's fat bounds and the leaf had to be reinserted.
+	bool Move(int32_t proxy, const AABB& box);
+
+	uint32_t UserData(int32_t proxy) const;
+
+	const AABB& FatBounds(int32_t proxy) const;
+
+	// Leaves below a node fully inside the frustum go to inside. Leaves whose parent only intersects it are not
+	// tested against their fat bounds and go to intersecting, for the caller to test against tighter bounds.
+	void QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& inside, std::vector<uint32_t>& intersecting) const;
+
+	// hitTest(userData, maxDistance) returns the distance along the ray to the object, or a negative value
+	// if it misses or is further than maxDistance. Returns false if nothing was hit.
+	bool RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+		const std::function<float(uint32_t, float)>& hitTest, uint32_t& hitUserData, float& hitDistance) const;
+
+	// distance2(userData) returns the squared distance from the query point to the object. Returns false if empty.
+	bool Nearest(const glm::vec3& point, const std::function<float(uint32_t)>& distance2, uint32_t& nearestUserData) const;
+
+	int32_t Height() const;
+
+	// Walks the whole tree and throws if a parent link, height or enclosing box is wrong; returns the leaf count.
+	size_t Validate() const;
+
+private:
+	struct Node
+	{
+		AABB box;
+		int32_t parent;
+		int32_t left;
+		int32_t right;
+		int32_t height;
+		uint32_t userData;
+
+		bool IsLeaf() const;
+	};
+
+	int32_t allocateNode();
+
+	void freeNode(int32_t node);
+
+	void insertLeaf(int32_t leaf);
+
+	void removeLeaf(int32_t leaf);
+
+	void refit(int32_t node);
+
+	int32_t balance(int32_t node);
+
+	void replaceChild(int32_t parent, int32_t oldChild, int32_t newChild);
+
+	std::vector<Node> nodes;
+	int32_t root{ BVH_NULL_NODE };
+	int32_t freeList{ BVH_NULL_NODE };
+};
@@ -0,0 +1,159 @@
+#include "GeometryPool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+GeometryPool::RangeAllocator::RangeAllocator(uint32_t capacity)
+{
+	freeRanges.emplace(0, capacity);
+}
+
+bool GeometryPool::RangeAllocator::Allocate(uint32_t size, uint32_t& offset)
+{
+	for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+		if (it->second < size) {
+			continue;
+		}
+		offset = it->first;
+		uint32_t remaining = it->second - size;
+		freeRanges.erase(it);
+		if (remaining) {
+			freeRanges.emplace(offset + size, remaining);
+		}
+		return true;
+	}
+	return false;
+}
+
+void GeometryPool::RangeAllocator::Free(uint32_t offset, uint32_t size)
+{
+	auto next = freeRanges.lower_bound(offset);
+	if (next != freeRanges.end() && offset + size == next->first) {
+		size += next->second;
+		next = freeRanges.erase(next);
+	}
+	if (next != freeRanges.begin()) {
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == offset) {
+			previous->second += size;
+			return;
+		}
+	}
+	freeRanges.emplace(offset, size);
+}
+
+GeometryPool::GeometryPool(RHIDriverRef driver)
+	: driver(driver), blockCount(0)
+{
+}
+
+GeometryPool::Block& GeometryPool::createBlock(uint32_t vertexCapacity, uint32_t indexCapacity)
+{
+	uint32_t index = blockCount.load(std::memory_order_relaxed);
+	if (index == GEOMETRY_MAX_BLOCKS) {
+		throw std::runtime_error("geometry pool is out of blocks");
+	}
+
+	BufferInfo vertexInfo{ .usage = BufferUsage::Vertex };
+	BufferInfo indexInfo{ .usage = BufferUsage::Index };
+
+	blocks[index] = std::unique_ptr<Block>(new Block{
+		.positions = driver->CreateBuffer(vertexCapacity * sizeof(glm::vec3), vertexInfo),
+		.colors = driver->CreateBuffer(vertexCapacity * sizeof(glm::vec3), vertexInfo),
+		.texCoords = driver->CreateBuffer(vertexCapacity * sizeof(glm::vec2), vertexInfo),
+		.indices = driver->CreateBuffer(indexCapacity * sizeof(uint16_t), indexInfo),
+		.vertices = RangeAllocator(vertexCapacity),
+		.indexRanges = RangeAllocator(indexCapacity),
+	});
+	blockCount.store(index + 1, std::memory_order_release);
+	return *blocks[index];
+}
+
+GeometryAllocation GeometryPool::Allocate(
+	const std::vector<glm::vec3>& positions,
+	const std::vector<uint16_t>& indices,
+	const std::vector<glm::vec3>& colors,
+	const std::vector<glm::vec2>& texCoords)
+{
+	if (colors.size() != positions.size() || texCoords.size() != positions.size()) {
+		throw std::runtime_error("mesh vertex streams differ in length");
+	}
+
+	GeometryAllocation allocation{
+		.block = 0,
+		.vertexOffset = 0,
+		.vertexCount = (uint32_t)positions.size(),
+		.firstIndex = 0,
+		.indexCount = (uint32_t)indices.size(),
+	};
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	recycle();
+
+	uint32_t count = blockCount.load(std::memory_order_relaxed);
+	Block* block = nullptr;
+	for (uint32_t i = 0; i < count && !block; i++) {
+		if (!blocks[i]->vertices.Allocate(allocation.vertexCount, allocation.vertexOffset)) {
+			continue;
+		}
+		if (!blocks[i]->indexRanges.Allocate(allocation.indexCount, allocation.firstIndex)) {
+			blocks[i]->vertices.Free(allocation.vertexOffset, allocation.vertexCount);
+			continue;
+		}
+		allocation.block = i;
+		block = blocks[i].get();
+	}
+
+	if (!block) {
+		allocation.block = count;
+		block = &createBlock(std::max(GEOMETRY_BLOCK_VERTICES, allocation.vertexCount),
+			std::max(GEOMETRY_BLOCK_INDICES, allocation.indexCount));
+		block->vertices.Allocate(allocation.vertexCount, allocation.vertexOffset);
+		block->indexRanges.Allocate(allocation.indexCount, allocation.firstIndex);
+	}
+
+	block->positions->Write(positions.data(), positions.size() * sizeof(glm::vec3), allocation.vertexOffset * sizeof(glm::vec3));
+	block->colors->Write(colors.data(), colors.size() * sizeof(glm::vec3), allocation.vertexOffset * sizeof(glm::vec3));
+	block->texCoords->Write(texCoords.data(), texCoords.size() * sizeof(glm::vec2), allocation.vertexOffset * sizeof(glm::vec2));
+	block->indices->Write(indices.data(), indices.size() * sizeof(uint16_t), allocation.firstIndex * sizeof(uint16_t));
+
+	return allocation;
+}
+
+void GeometryPool::Free(const GeometryAllocation& allocation)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	retired.push_back(Retired{ .allocation = allocation, .frame = driver->FrameNumber() });
+}
+
+void GeometryPool::recycle()
+{
+	uint64_t frame = driver->FrameNumber();
+	uint32_t framesInFlight = driver->FramesInFlight();
+
+	auto expired = std::partition(retired.begin(), retired.end(), [&](const Retired& r) {
+		return frame - r.frame < framesInFlight;
+	});
+	for (auto it = expired; it != retired.end(); ++it) {
+		Block& block = *blocks[it->allocation.block];
+		block.vertices.Free(it->allocation.vertexOffset, it->allocation.vertexCount);
+		block.indexRanges.Free(it->allocation.firstIndex, it->allocation.indexCount);
+	}
+	retired.erase(expired, retired.end());
+}
+
+void GeometryPool::Bind(const RHICommandListRef& commandList, uint32_t block)
+{
+	// A block's buffers never change once it is published, so recording threads need no lock here.
+	const Block& b = *blocks[block];
+	commandList->BindVertexBuffer(b.positions, 0);
+	commandList->BindVertexBuffer(b.colors, 1);
+	commandList->BindVertexBuffer(b.texCoords, 2);
+	commandList->BindIndexBuffer(b.indices);
+}
+
+size_t GeometryPool::BlockCount()
+{
+	return blockCount.load(std::memory_order_acquire);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "muffin/graphics/rhi/RHI.h"
+
+#include <atomic>
+#include <glm/glm.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+const uint32_t GEOMETRY_BLOCK_VERTICES = 256 * 1024;
+const uint32_t GEOMETRY_BLOCK_INDICES = 1024 * 1024;
+// Blocks live in a fixed array, so that Bind can read them without locking while Allocate adds more.
+const uint32_t GEOMETRY_MAX_BLOCKS = 256;
+
+class GeometryPool;
+using GeometryPoolRef = std::shared_ptr<GeometryPool>;
+
+// Where a mesh's vertices and indices live in the pool. Indices are relative to vertexOffset.
+struct GeometryAllocation
+{
+	uint32_t block;
+	uint32_t vertexOffset;
+	uint32_t vertexCount;
+	uint32_t firstIndex;
+	uint32_t indexCount;
+};
+
+// Vertex and index data of many meshes sub-allocated out of a few large buffers, one set per block,
+// so consecutive draws of meshes in the same block share their vertex and index bindings and can be
+// merged into one multi-draw. Blocks are added when full; a mesh larger than a block gets its own.
+// All methods may be called from any thread. Freed ranges are reused once the driver's frame number shows
+// that no frame in flight can still read them.
+class GeometryPool
+{
+public:
+	explicit GeometryPool(RHIDriverRef driver);
+
+	GeometryAllocation Allocate(
+		const std::vector<glm::vec3>& positions,
+		const std::vector<uint16_t>& indices,
+		const std::vector<glm::vec3>& colors,
+		const std::vector<glm::vec2>& texCoords);
+
+	void Free(const GeometryAllocation& allocation);
+
+	// Binds block's vertex streams at bindings 0-2 and its index buffer.
+	void Bind(const RHICommandListRef& commandList, uint32_t block);
+
+	size_t BlockCount();
+
+private:
+	// First-fit free list over [0, capacity), adjacent free ranges merged.
+	class RangeAllocator
+	{
+	public:
+		explicit RangeAllocator(uint32_t capacity);
+
+		// Returns false if no free range is large enough.
+		bool Allocate(uint32_t size, uint32_t& offset);
+
+		void Free(uint32_t offset, uint32_t size);
+
+	private:
+		std::map<uint32_t, uint32_t> freeRanges;
+	};
+
+	struct Block
+	{
+		RHIBufferRef positions;
+		RHIBufferRef colors;
+		RHIBufferRef texCoords;
+		RHIBufferRef indices;
+		RangeAllocator vertices;
+		RangeAllocator indexRanges;
+	};
+
+	struct Retired
+	{
+		GeometryAllocation allocation;
+		uint64_t frame;
+	};
+
+	Block& createBlock(uint32_t vertexCapacity, uint32_t indexCapacity);
+
+	// Returns ranges retired long enough ago to their blocks.
+	void recycle();
+
+	RHIDriverRef driver;
+	// Written under mutex; only blocks below blockCount are read.
+	std::unique_ptr<Block> blocks[GEOMETRY_MAX_BLOCKS];
+	std::atomic<uint32_t> blockCount;
+	std::vector<Retired> retired;
+
+	std::mutex mutex;
+};
@@ -0,0 +1,182 @@
+#include "GpuCulling.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+static const uint32_t CULL_GROUP_SIZE = 64;
+
+// Matches CullUniforms in cull.comp.
+struct CullUniforms
+{
+	glm::vec4 planes[6];
+	uint32_t objectCount;
+};
+
+GpuCulling::GpuCulling(RHIDriverRef driver, RHIShaderRef cullShader)
+	: driver(driver)
+{
+	// Each group's commands start at its first object's instance.
+	if (!driver->SupportsDrawIndirectFirstInstance()) {
+		throw std::runtime_error("GPU culling requires drawIndirectFirstInstance");
+	}
+	pipeline = driver->CreateComputePipeline(ComputePipelineCreateInfo{ .computeShader = cullShader });
+}
+
+void GpuCulling::SetObjects(const std::vector<RenderObjectRef>& newObjects)
+{
+	objects = newObjects;
+	// Groups sharing a material and geometry block end up adjacent, so Draw can merge them.
+	std::sort(objects.begin(), objects.end(), [](const RenderObjectRef& a, const RenderObjectRef& b) {
+		if (a->GetMaterial() != b->GetMaterial()) {
+			return a->GetMaterial() < b->GetMaterial();
+		}
+		if (a->GetMesh()->Block() != b->GetMesh()->Block()) {
+			return a->GetMesh()->Block() < b->GetMesh()->Block();
+		}
+		return a->GetMesh() < b->GetMesh();
+	});
+
+	groups.clear();
+	objectGroups.clear();
+	commandTemplates.clear();
+
+	for (size_t i = 0; i < objects.size(); i++) {
+		const RenderObjectRef& obj = objects[i];
+		if (groups.empty() || groups.back().material != obj->GetMaterial() || groups.back().mesh != obj->GetMesh()) {
+			groups.push_back(Group{ .material = obj->GetMaterial(), .mesh = obj->GetMesh() });
+			commandTemplates.push_back(DrawIndexedIndirectCommand{
+				.indexCount = obj->GetMesh()->IndexCount(),
+				.instanceCount = 0,
+				.firstIndex = obj->GetMesh()->FirstIndex(),
+				.vertexOffset = obj->GetMesh()->VertexOffset(),
+				.firstInstance = (uint32_t)i,
+			});
+		}
+		objectGroups.push_back(groups.size() - 1);
+	}
+
+	instances.resize(objects.size());
+	transformInstances.clear();
+	dirtyInstances.clear();
+	instanceDirty.assign(objects.size(), 0);
+
+	for (size_t i = 0; i < objects.size(); i++) {
+		const BoundingSphere& sphere = objects[i]->GetMesh()->GetBounds().sphere;
+		instances[i].model = objects[i]->WorldTransform();
+		instances[i].sphere = glm::vec4(sphere.center, sphere.radius);
+		instances[i].group = objectGroups[i];
+
+		TransformId transform = objects[i]->GetTransformId();
+		if (transform != NULL_TRANSFORM) {
+			if (transform >= transformInstances.size()) {
+				transformInstances.resize(transform + 1, UINT32_MAX);
+			}
+			transformInstances[transform] = i;
+		}
+	}
+
+	templates.reset();
+	commands.reset();
+	visibleTransforms.reset();
+	instanceBuffer.reset();
+
+	if (objects.empty()) {
+		return;
+	}
+
+	uint32_t commandsSize = commandTemplates.size() * sizeof(DrawIndexedIndirectCommand);
+	templates = driver->CreateBuffer(commandsSize, BufferInfo{ .usage = BufferUsage::Indirect });
+	templates->Write(commandTemplates.data(), commandsSize);
+	commands = driver->CreateBuffer(commandsSize, BufferInfo{ .usage = BufferUsage::Indirect, .shaderWrite = true });
+	visibleTransforms = driver->CreateBuffer(objects.size() * sizeof(glm::mat4),
+		BufferInfo{ .usage = BufferUsage::Vertex, .shaderWrite = true });
+	instanceBuffer = driver->CreateBuffer(objects.size() * sizeof(Instance), BufferInfo{ .usage = BufferUsage::Storage });
+	instanceBuffer->Write(instances.data(), objects.size() * sizeof(Instance));
+}
+
+void GpuCulling::TransformsChanged(const std::vector<TransformId>& changed)
+{
+	for (TransformId transform : changed) {
+		if (transform >= transformInstances.size() || transformInstances[transform] == UINT32_MAX) {
+			continue;
+		}
+		uint32_t instance = transformInstances[transform];
+		if (!instanceDirty[instance]) {
+			instanceDirty[instance] = 1;
+			dirtyInstances.push_back(instance);
+		}
+	}
+}
+
+void GpuCulling::Dispatch(const RHICommandListRef& commandList, const Frustum& frustum)
+{
+	if (objects.empty()) {
+		return;
+	}
+
+	CullUniforms uniforms;
+	std::copy(std::begin(frustum.planes), std::end(frustum.planes), uniforms.planes);
+	uniforms.objectCount = objects.size();
+
+	// The previous frame's culling and draws may still be using the buffers about to be reset or rewritten.
+	commandList->Barrier(BarrierCompute | BarrierIndirect | BarrierVertexInput, BarrierTransfer);
+	commandList->CopyBuffer(templates, 0, commands, 0, commandTemplates.size() * sizeof(DrawIndexedIndirectCommand));
+
+	// Only moved objects cost CPU time: their instances are rewritten in runs of adjacent indices, each
+	// within the 64 KiB UpdateBuffer limit.
+	const size_t instancesPerUpdate = 65536 / sizeof(Instance);
+	std::sort(dirtyInstances.begin(), dirtyInstances.end());
+	for (size_t first = 0; first < dirtyInstances.size();) {
+		size_t end = first + 1;
+		while (end < dirtyInstances.size() && dirtyInstances[end] == dirtyInstances[end - 1] + 1 &&
+			end - first < instancesPerUpdate) {
+			end++;
+		}
+
+		uint32_t begin = dirtyInstances[first];
+		for (uint32_t i = begin; i < begin + (end - first); i++) {
+			instances[i].model = objects[i]->WorldTransform();
+			instanceDirty[i] = 0;
+		}
+		commandList->UpdateBuffer(instanceBuffer, begin * sizeof(Instance), &instances[begin], (end - first) * sizeof(Instance));
+		first = end;
+	}
+	dirtyInstances.clear();
+
+	commandList->Barrier(BarrierTransfer, BarrierCompute);
+
+	commandList->BindComputePipeline(pipeline);
+	commandList->BindUniformData("cull", &uniforms, sizeof(uniforms));
+	commandList->BindStorageBuffer("instances", instanceBuffer);
+	commandList->BindStorageBuffer("commands", commands);
+	commandList->BindStorageBuffer("visible", visibleTransforms);
+	commandList->Dispatch((objects.size() + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+	commandList->Barrier(BarrierCompute, BarrierIndirect | BarrierVertexInput);
+}
+
+void GpuCulling::Draw(const RHICommandListRef& commandList)
+{
+	bool multiDraw = driver->SupportsMultiDrawIndirect();
+
+	for (size_t first = 0; first < groups.size();) {
+		// Groups with the same material in the same geometry block differ only in their draw arguments.
+		size_t end = first + 1;
+		while (multiDraw && end < groups.size() && groups[end].material == groups[first].material &&
+			groups[end].mesh->Block() == groups[first].mesh->Block()) {
+			end++;
+		}
+
+		groups[first].material->Bind(commandList);
+		groups[first].mesh->Bind(commandList);
+		commandList->BindVertexBuffer(visibleTransforms, INSTANCE_BUFFER_BINDING);
+		commandList->DrawIndexedIndirect(commands, first * sizeof(DrawIndexedIndirectCommand), end - first,
+			sizeof(DrawIndexedIndirectCommand));
+		first = end;
+	}
+}
+
+size_t GpuCulling::ObjectCount() const
+{
+	return objects.size();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Culling.h"
+#include "RenderObject.h"
+#include "muffin/graphics/rhi/RHI.h"
+
+#include <memory>
+#include <vector>
+
+class GpuCulling;
+using GpuCullingRef = std::shared_ptr<GpuCulling>;
+
+// Frustum culling of a fixed set of opaque objects on the GPU. A compute pass tests every object's
+// bounding sphere and writes the visible ones' transforms and instance counts straight into the buffers
+// the draws read, so drawing costs one indirect multi-draw per material and geometry block (one draw per
+// mesh without multiDrawIndirect) whatever is visible.
+// Requires RHIDriver::SupportsDrawIndirectFirstInstance; the objects must not also be enqueued in the Renderer.
+class GpuCulling
+{
+public:
+	// cullShader is cull.comp. Throws when the driver lacks drawIndirectFirstInstance.
+	GpuCulling(RHIDriverRef driver, RHIShaderRef cullShader);
+
+	// Rebuilds the draw groups and uploads every instance; call when objects are added, removed or change
+	// mesh or material.
+	void SetObjects(const std::vector<RenderObjectRef>& objects);
+
+	// Marks the objects owning these transforms for rewriting in the next Dispatch; pass what Scene::Update returns.
+	void TransformsChanged(const std::vector<TransformId>& changed);
+
+	// Records the culling pass. Must be outside a render pass, before Draw in the same frame.
+	void Dispatch(const RHICommandListRef& commandList, const Frustum& frustum);
+
+	// Records the indirect draws, inside the render pass with the camera bound.
+	void Draw(const RHICommandListRef& commandList);
+
+	size_t ObjectCount() const;
+
+private:
+	struct Group
+	{
+		MaterialRef material;
+		MeshRef mesh;
+	};
+
+	// Matches Instance in cull.comp (std430).
+	struct Instance
+	{
+		glm::mat4 model;
+		glm::vec4 sphere;
+		uint32_t group;
+		uint32_t padding[3];
+	};
+
+	RHIDriverRef driver;
+	RHIComputePipelineRef pipeline;
+
+	std::vector<RenderObjectRef> objects;
+	std::vector<uint32_t> objectGroups;
+	std::vector<Group> groups;
+	std::vector<DrawIndexedIndirectCommand> commandTemplates;
+	std::vector<Instance> instances;
+
+	// Instance index of each object's transform, UINT32_MAX for transforms not culled here.
+	std::vector<uint32_t> transformInstances;
+	std::vector<uint32_t> dirtyInstances;
+	std::vector<uint8_t> instanceDirty;
+
+	// commandTemplates, with zero instances, copied over the GPU-written commands before each pass.
+	RHIBufferRef templates;
+	// instances on the GPU; only the entries in dirtyInstances are rewritten each frame.
+	RHIBufferRef instanceBuffer;
+	RHIBufferRef commands;
+	RHIBufferRef visibleTransforms;
+};
@@ -1,7 +1,33 @@
 #include "Material.h"
 
-Material::Material(RHIDriverRef driver, RHIShaderRef vertexShader, RHIShaderRef fragmentShader, RHITextureRef texture)
-	: driver(driver), texture(texture)
+Material::Material(RHIDriverRef driver, RHIGraphicsPipelineRef pipeline, RHITextureRef texture, bool bindless)
+	: driver(driver), graphicsPipeline(pipeline), texture(texture), bindless(bindless), textureIndex(0), transparent(false)
+{
+	sampler = driver->CreateSampler();
+
+	if (bindless) {
+		textureIndex = driver->RegisterBindlessTexture(texture, sampler);
+	}
+}
+
+Material::~Material()
+{
+	if (bindless) {
+		driver->ReleaseBindlessTexture(textureIndex);
+	}
+}
+
+void Material::Bind(RHICommandListRef commandList)
+{
+	commandList->BindPipeline(graphicsPipeline);
+	if (bindless) {
+		commandList->PushConstants(0, sizeof(textureIndex), &textureIndex);
+	} else {
+		commandList->BindTexture("texSampler", texture, sampler);
+	}
+}
+
+RHIGraphicsPipelineRef Material::CreatePipeline(RHIDriverRef driver, RHIShaderRef vertexShader, RHIShaderRef fragmentShader)
 {
 	GraphicsPipelineCreateInfo createInfo;
 	createInfo.vertexShader = vertexShader;
@@ -10,31 +36,30 @@ Material::Material(RHIDriverRef driver, RHIShaderRef vertexShader, RHIShaderRef
 	createInfo.rasterizer.cullMode = CullMode::Back;
 	createInfo.rasterizer.faceOrientation = FaceOrientation::CounterClockwise;
 
-	graphicsPipeline = driver->CreateGraphicsPipeline(createInfo);
-	sampler = driver->CreateSampler();
+	return driver->CreateGraphicsPipeline(createInfo);
+}
 
-	BufferInfo uboInfo;
-	uboInfo.usage = BufferUsage::Uniform;
-	uboBuffer = driver->CreateBuffer(sizeof(UniformBufferObject), uboInfo);
+MaterialRef Material::Create(RHIDriverRef driver, RHIShaderRef vertexShader, RHIShaderRef fragmentShader, RHITextureRef texture)
+{
+	return MaterialRef(new Material(driver, CreatePipeline(driver, vertexShader, fragmentShader), texture, false));
 }
 
-void Material::Bind(RHICommandListRef commandList)
+MaterialRef Material::CreateBindless(RHIDriverRef driver, RHIGraphicsPipelineRef pipeline, RHITextureRef texture)
 {
-	commandList->BindPipeline(graphicsPipeline);
-	commandList->BindTexture("texSampler", texture, sampler);
-	commandList->BindUniformBuffer("ubo", uboBuffer, sizeof(UniformBufferObject));
+	return MaterialRef(new Material(driver, pipeline, texture, true));
 }
 
-MaterialRef Material::Create(RHIDriverRef driver, RHIShaderRef vertexShader, RHIShaderRef fragmentShader, RHITextureRef texture)
+const RHIGraphicsPipelineRef& Material::Pipeline() const
 {
-	return MaterialRef(new Material(driver, vertexShader, fragmentShader, texture));
+	return graphicsPipeline;
 }
 
-void Material::UpdateUBO(const UniformBufferObject& newUBO)
+void Material::SetTransparent(bool value)
 {
-	BufferInfo uboInfo;
-	uboInfo.usage = BufferUsage::Uniform;
+	transparent = value;
+}
 
-	uboBuffer = driver->CreateBuffer(sizeof(UniformBufferObject), uboInfo);
-	uboBuffer->Write((void*)&newUBO, sizeof(UniformBufferObject));
+bool Material::IsTransparent() const
+{
+	return transparent;
 }
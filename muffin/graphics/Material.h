@@ -3,34 +3,41 @@
 #include "muffin/graphics/rhi/RHI.h"
 #include <string>
 
-#include <glm/glm.hpp>
 #include <memory>
 
-struct UniformBufferObject
-{
-	glm::mat4 model;
-	glm::mat4 view;
-	glm::mat4 proj;
-};
-
 class Material;
 using MaterialRef = std::shared_ptr<Material>;
 
 class Material
 {
 public:
+	~Material();
+
 	void Bind(RHICommandListRef commandList);
 
+	static RHIGraphicsPipelineRef CreatePipeline(RHIDriverRef driver, RHIShaderRef vertexShader, RHIShaderRef fragmentShader);
+
 	static MaterialRef Create(RHIDriverRef driver, RHIShaderRef vertexShader, RHIShaderRef fragmentShader, RHITextureRef texture);
 
-	void UpdateUBO(const UniformBufferObject& newUBO);
+	// Registers texture in the driver's bindless table; pipeline's fragment shader reads it through a
+	// uint textureIndex push constant. Materials can share the pipeline, so switching between them
+	// costs a push constant instead of a descriptor set.
+	static MaterialRef CreateBindless(RHIDriverRef driver, RHIGraphicsPipelineRef pipeline, RHITextureRef texture);
+
+	const RHIGraphicsPipelineRef& Pipeline() const;
+
+	void SetTransparent(bool value);
+
+	bool IsTransparent() const;
 
 private:
-	Material(RHIDriverRef driver, RHIShaderRef vertexShader, RHIShaderRef fragmentShader, RHITextureRef texture);
+	Material(RHIDriverRef driver, RHIGraphicsPipelineRef pipeline, RHITextureRef texture, bool bindless);
 
 	RHIDriverRef driver;
 	RHIGraphicsPipelineRef graphicsPipeline;
 	RHITextureRef texture;
-	RHIBufferRef uboBuffer;
 	RHISamplerRef sampler;
-};
\ No newline at end of file
+	bool bindless;
+	BindlessIndex textureIndex;
+	bool transparent;
+};
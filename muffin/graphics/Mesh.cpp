@@ -1,49 +1,64 @@
 #include "Mesh.h"
 
 Mesh::Mesh(
-	RHIDriverRef driver,
+	GeometryPoolRef pool,
 	const std::vector<glm::vec3>& triangles,
 	const std::vector<uint16_t>& indices,
 	const std::vector<glm::vec3>& colors,
 	const std::vector<glm::vec2>& texCoords)
+	: pool(pool)
 {
+	geometry = pool->Allocate(triangles, indices, colors, texCoords);
+	bounds = Bounds::FromPoints(triangles);
+}
 
-	BufferInfo vertexInfo;
-	vertexInfo.usage = BufferUsage::Vertex;
+Mesh::~Mesh()
+{
+	pool->Free(geometry);
+}
 
-	trianglesBuf = driver->CreateBuffer(triangles.size() * sizeof(glm::vec3), vertexInfo);
-	trianglesBuf->Write((void*)triangles.data(), triangles.size() * sizeof(glm::vec3));
+void Mesh::Draw(RHICommandListRef commandList, uint32_t instanceCount)
+{
+	Bind(commandList);
+	commandList->DrawIndexed(geometry.indexCount, instanceCount, geometry.firstIndex, geometry.vertexOffset, 0);
+}
 
-	colorsBuf = driver->CreateBuffer(colors.size() * sizeof(glm::vec3), vertexInfo);
-	colorsBuf->Write((void*)colors.data(), colors.size() * sizeof(glm::vec3));
+void Mesh::Bind(const RHICommandListRef& commandList)
+{
+	pool->Bind(commandList, geometry.block);
+}
 
-	texCoordsBuf = driver->CreateBuffer(texCoords.size() * sizeof(glm::vec2), vertexInfo);
-	texCoordsBuf->Write((void*)texCoords.data(), texCoords.size() * sizeof(glm::vec2));
+uint32_t Mesh::IndexCount() const
+{
+	return geometry.indexCount;
+}
 
-	BufferInfo indexInfo;
-	indexInfo.usage = BufferUsage::Index;
+uint32_t Mesh::FirstIndex() const
+{
+	return geometry.firstIndex;
+}
 
-	indicesBuf = driver->CreateBuffer(indices.size() * sizeof(uint16_t), indexInfo);
-	indicesBuf->Write((void*)indices.data(), indices.size() * sizeof(uint16_t));
-	indicesSize = indices.size();
+int32_t Mesh::VertexOffset() const
+{
+	return geometry.vertexOffset;
 }
 
-void Mesh::Draw(RHICommandListRef commandList)
+uint32_t Mesh::Block() const
 {
-	commandList->BindVertexBuffer(trianglesBuf, 0);
-	commandList->BindVertexBuffer(colorsBuf, 1);
-	commandList->BindVertexBuffer(texCoordsBuf, 2);
-	commandList->BindIndexBuffer(indicesBuf);
+	return geometry.block;
+}
 
-	commandList->DrawIndexed(indicesSize, 1, 0, 0, 0);
+const Bounds& Mesh::GetBounds() const
+{
+	return bounds;
 }
 
 MeshRef Mesh::Create(
-	RHIDriverRef driver,
+	GeometryPoolRef pool,
 	const std::vector<glm::vec3>& triangles,
 	const std::vector<uint16_t>& indices,
 	const std::vector<glm::vec3>& colors,
 	const std::vector<glm::vec2>& texCoords)
 {
-	return MeshRef(new Mesh(driver, triangles, indices, colors, texCoords));
+	return MeshRef(new Mesh(pool, triangles, indices, colors, texCoords));
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Bounds.h"
+#include "GeometryPool.h"
 #include "muffin/graphics/rhi/RHI.h"
 
 #include <glm/glm.hpp>
@@ -9,13 +11,32 @@
 class Mesh;
 using MeshRef = std::shared_ptr<Mesh>;
 
+// Geometry stored in a GeometryPool; the range is handed back to the pool when the mesh is destroyed.
 class Mesh
 {
 public:
-	void Draw(RHICommandListRef commandList);
+	~Mesh();
+
+	void Draw(RHICommandListRef commandList, uint32_t instanceCount);
+
+	// Binds the pool block's vertex and index buffers, for draws whose arguments come from elsewhere
+	// (e.g. indirect). Meshes in the same block share these bindings.
+	void Bind(const RHICommandListRef& commandList);
+
+	uint32_t IndexCount() const;
+
+	// Offsets into the pool block for DrawIndexed and indirect commands.
+	uint32_t FirstIndex() const;
+
+	int32_t VertexOffset() const;
+
+	uint32_t Block() const;
+
+	// Object-space bounds of the vertex positions.
+	const Bounds& GetBounds() const;
 
 	static MeshRef Create(
-		RHIDriverRef driver,
+		GeometryPoolRef pool,
 		const std::vector<glm::vec3>& triangles,
 		const std::vector<uint16_t>& indices,
 		const std::vector<glm::vec3>& colors,
@@ -23,16 +44,14 @@ public:
 
 private:
 	Mesh(
-		RHIDriverRef driver,
+		GeometryPoolRef pool,
 		const std::vector<glm::vec3>& triangles,
 		const std::vector<uint16_t>& indices,
 		const std::vector<glm::vec3>& colors,
 		const std::vector<glm::vec2>& texCoords);
 
-	RHIBufferRef trianglesBuf;
-	RHIBufferRef indicesBuf;
-	RHIBufferRef colorsBuf;
-	RHIBufferRef texCoordsBuf;
+	GeometryPoolRef pool;
+	GeometryAllocation geometry;
 
-	int indicesSize;
-};
\ No newline at end of file
+	Bounds bounds;
+};
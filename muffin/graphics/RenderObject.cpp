@@ -1,7 +1,7 @@
 #include "RenderObject.h"
+#include "Scene.h"
 
 #include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
 
 RenderObjectRef RenderObject::Create(const std::string &name, MeshRef mesh, MaterialRef material)
 {
@@ -9,32 +9,78 @@ RenderObjectRef RenderObject::Create(const std::string &name, MeshRef mesh, Mate
 }
 
 RenderObject::RenderObject(const std::string &name, MeshRef mesh, MaterialRef material)
-	: name(name), mesh(mesh), material(material)
+	: name(name), mesh(mesh), material(material), scene(nullptr), transform(NULL_TRANSFORM), proxy(-1), localTransform(1.f)
 {
 }
 
 void RenderObject::Render(RHICommandListRef commandList)
+{
+	commandList->BindVertexData(&WorldTransform(), sizeof(glm::mat4), INSTANCE_BUFFER_BINDING);
+	RenderInstanced(commandList, 1);
+}
+
+void RenderObject::RenderInstanced(RHICommandListRef commandList, uint32_t instanceCount)
 {
 	material->Bind(commandList);
-	mesh->Draw(commandList);
+	mesh->Draw(commandList, instanceCount);
 }
 
-void RenderObject::SetTransform(const glm::mat4 &newTransform)
+SortInfo RenderObject::GetSortInfo()
 {
-    transform = newTransform;
+	const glm::mat4& world = WorldTransform();
+	return SortInfo{
+		.bucket = material->IsTransparent() ? RenderBucket::Transparent : RenderBucket::Opaque,
+		.pipeline = material->Pipeline().get(),
+		.material = material.get(),
+		.mesh = mesh.get(),
+		.position = glm::vec3(world[3]),
+		.transform = &world,
+	};
+}
 
-    UniformBufferObject ubo;
-    ubo.view = glm::lookAt(glm::vec3(0.0f, 5.0f, 5.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.proj = glm::perspective(glm::radians(45.0f), 800.f / 600.f, 0.1f, 10.0f);
-    ubo.model = transform;
-    ubo.proj[1][1] *= -1;
-	material->UpdateUBO(ubo);
+void RenderObject::SetTransform(const glm::mat4 &newTransform)
+{
+	if (!scene) {
+		localTransform = newTransform;
+		return;
+	}
+	scene->transforms.SetLocal(transform, newTransform);
 }
 
 const glm::mat4 &RenderObject::GetTransform() {
-    return transform;
+	return scene ? scene->transforms.Local(transform) : localTransform;
+}
+
+const glm::mat4& RenderObject::WorldTransform() const
+{
+	return scene ? scene->transforms.World(transform) : localTransform;
 }
 
 const std::string &RenderObject::Name() {
     return name;
-}
\ No newline at end of file
+}
+
+const MeshRef& RenderObject::GetMesh() const
+{
+	return mesh;
+}
+
+const MaterialRef& RenderObject::GetMaterial() const
+{
+	return material;
+}
+
+BoundingSphere RenderObject::WorldBounds() const
+{
+	return mesh->GetBounds().sphere.Transform(WorldTransform());
+}
+
+AABB RenderObject::WorldBox() const
+{
+	return mesh->GetBounds().box.Transform(WorldTransform());
+}
+
+TransformId RenderObject::GetTransformId() const
+{
+	return transform;
+}
@@ -3,6 +3,7 @@
 #include "Material.h"
 #include "Mesh.h"
 #include "Renderable.h"
+#include "TransformStore.h"
 #include "muffin/graphics/rhi/RHI.h"
 
 #include <memory>
@@ -19,17 +20,43 @@ public:
 
 	virtual void Render(RHICommandListRef commandList) override;
 
+	virtual void RenderInstanced(RHICommandListRef commandList, uint32_t instanceCount) override;
+
+	virtual SortInfo GetSortInfo() override;
+
+	// Sets the transform relative to the parent; the world matrix follows on the scene's next Update().
+	// Outside a scene the object has no parent and the matrix is its world transform.
 	void SetTransform(const glm::mat4& newTransform);
 
 	const glm::mat4& GetTransform();
 
+	const glm::mat4& WorldTransform() const;
+
+	BoundingSphere WorldBounds() const;
+
+	AABB WorldBox() const;
+
 	const std::string& Name();
 
+	const MeshRef& GetMesh() const;
+
+	const MaterialRef& GetMaterial() const;
+
+	// NULL_TRANSFORM until the object is added to a scene.
+	TransformId GetTransformId() const;
+
 private:
 	RenderObject(const std::string& name, MeshRef mesh, MaterialRef material);
 
 	std::string name;
 	MeshRef mesh;
 	MaterialRef material;
-	glm::mat4 transform;
+
+	// Set while the object belongs to a scene, which owns its transform and keeps its bounds in the scene's BVH.
+	friend class Scene;
+	class Scene* scene;
+	TransformId transform;
+	// The local matrix while the object is outside a scene; moved into and out of the scene's store.
+	glm::mat4 localTransform;
+	int32_t proxy;
 };
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "RenderQueue.h"
+
+#include <cstring>
+
+static const uint32_t PIPELINE_BITS = 12;
+static const uint32_t MATERIAL_BITS = 14;
+static const uint32_t MESH_BITS = 14;
+static const uint32_t DEPTH_BITS = 22;
+
+static const size_t SORT_INFO_GRAIN = 256;
+
+// Distances are non-negative, so the IEEE-754 bit pattern already sorts like the value.
+static uint32_t depthBits(float distance)
+{
+	uint32_t bits;
+	memcpy(&bits, &distance, sizeof(bits));
+	return bits;
+}
+
+static uint64_t field(uint64_t value, uint32_t bits)
+{
+	return value & ((uint64_t(1) << bits) - 1);
+}
+
+void RenderQueue::Push(RenderableRef renderable)
+{
+	renderables.push_back(std::move(renderable));
+}
+
+uint32_t RenderQueue::stateId(std::unordered_map<const void*, uint32_t>& ids, const void* state)
+{
+	auto [it, inserted] = ids.try_emplace(state, (uint32_t)ids.size());
+	return it->second;
+}
+
+uint64_t RenderQueue::makeKey(const SortInfo& info, const glm::vec3& viewPosition, uint32_t index)
+{
+	uint64_t key = uint64_t(info.bucket) << 62;
+
+	if (info.bucket == RenderBucket::Overlay) {
+		return key | index;
+	}
+
+	glm::vec3 d = info.position - viewPosition;
+	uint32_t depth = depthBits(glm::dot(d, d));
+
+	uint64_t pipeline = field(stateId(pipelineIds, info.pipeline), PIPELINE_BITS);
+	uint64_t material = field(stateId(materialIds, info.material), MATERIAL_BITS);
+
+	if (info.bucket == RenderBucket::Transparent) {
+		uint64_t farFirst = field(~depth >> 1, 30);
+		return key | farFirst << 32 | pipeline << 20 | material << 6;
+	}
+
+	uint64_t mesh = field(stateId(meshIds, info.mesh), MESH_BITS);
+	return key | pipeline << 50 | material << 36 | mesh << 22 | field(depth >> (32 - DEPTH_BITS - 1), DEPTH_BITS);
+}
+
+void RenderQueue::Sort(const glm::vec3& viewPosition, JobSystem& jobs)
+{
+	items.resize(renderables.size());
+	scratch.resize(renderables.size());
+
+	infos.resize(renderables.size());
+
+	jobs.ParallelFor(renderables.size(), SORT_INFO_GRAIN, [this](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			infos[i] = renderables[i]->GetSortInfo();
+		}
+	});
+
+	// State ids are handed out in queue order, so keys are built on this thread.
+	for (uint32_t i = 0; i < renderables.size(); i++) {
+		items[i] = Item{ .key = makeKey(infos[i], viewPosition, i), .index = i };
+	}
+
+	// LSD radix sort, one byte per pass; passes where every key has the same byte are skipped.
+	for (uint32_t shift = 0; shift < 64; shift += 8) {
+		size_t counts[256] = {};
+		for (const Item& item : items) {
+			counts[(item.key >> shift) & 0xff]++;
+		}
+		if (counts[(items.empty() ? 0 : items[0].key >> shift) & 0xff] == items.size()) {
+			continue;
+		}
+
+		size_t offset = 0;
+		for (size_t& count : counts) {
+			size_t c = count;
+			count = offset;
+			offset += c;
+		}
+		for (const Item& item : items) {
+			scratch[counts[(item.key >> shift) & 0xff]++] = item;
+		}
+		items.swap(scratch);
+	}
+
+	permute(renderables);
+	permute(infos);
+}
+
+template <typename T>
+void RenderQueue::permute(std::vector<T>& values)
+{
+	std::vector<T> sorted;
+	sorted.reserve(values.size());
+	for (const Item& item : items) {
+		sorted.push_back(std::move(values[item.index]));
+	}
+	values.swap(sorted);
+}
+
+void RenderQueue::Clear()
+{
+	renderables.clear();
+	infos.clear();
+	pipelineIds.clear();
+	materialIds.clear();
+	meshIds.clear();
+}
+
+size_t RenderQueue::Size() const
+{
+	return renderables.size();
+}
+
+const RenderableRef& RenderQueue::operator[](size_t i) const
+{
+	return renderables[i];
+}
+
+const SortInfo& RenderQueue::Info(size_t i) const
+{
+	return infos[i];
+}
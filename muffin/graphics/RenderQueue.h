@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Renderable.h"
+#include "muffin/core/JobSystem.h"
+
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+// Collects renderables for a frame and orders them by a 64-bit key:
+//   opaque:      bucket | pipeline | material | mesh | depth (front to back)
+//   transparent: bucket | depth (back to front) | pipeline | material
+//   overlay:     bucket | submission order
+class RenderQueue
+{
+public:
+	void Push(RenderableRef renderable);
+
+	void Sort(const glm::vec3& viewPosition, JobSystem& jobs);
+
+	void Clear();
+
+	size_t Size() const;
+
+	const RenderableRef& operator[](size_t i) const;
+
+	const SortInfo& Info(size_t i) const;
+
+private:
+	struct Item
+	{
+		uint64_t key;
+		uint32_t index;
+	};
+
+	uint64_t makeKey(const SortInfo& info, const glm::vec3& viewPosition, uint32_t index);
+
+	template <typename T>
+	void permute(std::vector<T>& values);
+
+	uint32_t stateId(std::unordered_map<const void*, uint32_t>& ids, const void* state);
+
+	std::vector<RenderableRef> renderables;
+	std::vector<SortInfo> infos;
+	std::vector<Item> items;
+	std::vector<Item> scratch;
+
+	std::unordered_map<const void*, uint32_t> pipelineIds;
+	std::unordered_map<const void*, uint32_t> materialIds;
+	std::unordered_map<const void*, uint32_t> meshIds;
+};
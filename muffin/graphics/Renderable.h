@@ -2,11 +2,40 @@
 
 #include "muffin/graphics/rhi/RHI.h"
 
+#include <glm/glm.hpp>
 #include <memory>
+#include <stdexcept>
+
+enum class RenderBucket : uint8_t
+{
+	Opaque,
+	Transparent,
+	Overlay,
+};
+
+struct SortInfo
+{
+	RenderBucket bucket{ RenderBucket::Overlay };
+	const void* pipeline{ nullptr };
+	const void* material{ nullptr };
+	const void* mesh{ nullptr };
+	glm::vec3 position{ 0.f };
+	// Renderables that expose a transform can be batched with neighbours sharing the same material and mesh.
+	const glm::mat4* transform{ nullptr };
+};
 
 struct Renderable
 {
 	virtual void Render(RHICommandListRef commandList) = 0;
+
+	// Draws instanceCount instances whose per-instance data is already bound at INSTANCE_BUFFER_BINDING.
+	// Required of renderables that set SortInfo::transform, since the Renderer batches those.
+	virtual void RenderInstanced(RHICommandListRef commandList, uint32_t instanceCount)
+	{
+		throw std::runtime_error("renderable with a transform does not implement RenderInstanced");
+	}
+
+	virtual SortInfo GetSortInfo() { return SortInfo{}; }
 };
 
 using RenderableRef = std::shared_ptr<Renderable>;
\ No newline at end of file
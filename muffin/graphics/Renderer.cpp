@@ -1,32 +1,191 @@
 #include "Renderer.h"
+#include "muffin/core/Profiler.h"
 
-Renderer::Renderer(RHIDriverRef driver)
-	: driver(driver)
+#include <algorithm>
+
+static const size_t MAX_INSTANCES_PER_DRAW = 16384;
+
+// Below this many batches per worker, recording inline is cheaper than the secondary list overhead.
+static const size_t MIN_BATCHES_PER_WORKER = 64;
+
+static bool canInstance(const SortInfo& first, const SortInfo& other)
+{
+	return other.transform && other.bucket == first.bucket && other.material == first.material && other.mesh == first.mesh;
+}
+
+Renderer::Renderer(RHIDriverRef driver, JobSystemRef jobs)
+	: driver(driver), jobs(jobs), viewUniforms{}
 {
 }
 
 void Renderer::Enqueue(RenderableRef obj)
 {
-	renderQueue.push_back(obj);
+	renderQueue.Push(obj);
+}
+
+void Renderer::buildBatches()
+{
+	batches.clear();
+
+	for (size_t i = 0; i < renderQueue.Size();) {
+		const SortInfo& info = renderQueue.Info(i);
+
+		size_t end = i + 1;
+		if (info.transform) {
+			while (end < renderQueue.Size() && end - i < MAX_INSTANCES_PER_DRAW && canInstance(info, renderQueue.Info(end))) {
+				end++;
+			}
+		}
+
+		batches.push_back(Batch{ .begin = i, .end = end });
+		i = end;
+	}
+}
+
+void Renderer::bindView(const RHICommandListRef& commandList)
+{
+	commandList->BindUniformData("camera", &viewUniforms, sizeof(ViewUniforms));
+}
+
+void Renderer::setViewport(const RHICommandListRef& commandList)
+{
+	commandList->SetViewport(200,  200, 800, 600);
+	commandList->SetScissors(200,  200, 800, 600);
+}
+
+void Renderer::drawGpuCulled(const RHICommandListRef& commandList)
+{
+	if (gpuCulling) {
+		setViewport(commandList);
+		gpuCulling->Draw(commandList);
+	}
+}
+
+void Renderer::recordBatches(const RHICommandListRef& commandList, size_t first, size_t last, std::vector<glm::mat4>& transforms)
+{
+	for (size_t b = first; b < last; b++) {
+		const Batch& batch = batches[b];
+
+		setViewport(commandList);
+
+		if (batch.end - batch.begin == 1) {
+			renderQueue[batch.begin]->Render(commandList);
+		} else {
+			transforms.clear();
+			for (size_t j = batch.begin; j < batch.end; j++) {
+				transforms.push_back(*renderQueue.Info(j).transform);
+			}
+			commandList->BindVertexData(transforms.data(), transforms.size() * sizeof(glm::mat4), INSTANCE_BUFFER_BINDING);
+			renderQueue[batch.begin]->RenderInstanced(commandList, batch.end - batch.begin);
+		}
+	}
 }
 
 void Renderer::Render()
 {
+	MUFFIN_PROFILE_SCOPE("Renderer::Render");
+
+	RHIRenderTargetRef renderTarget;
+	{
+		// Blocks while the GPU is still busy with the frame that last used this slot.
+		MUFFIN_PROFILE_SCOPE("Wait for frame");
+		renderTarget = driver->BeginFrame();
+	}
+
+	for (const GpuTiming& timing : driver->GpuTimings()) {
+		Profiler::Get().AddEvent(ProfileEvent{
+			.name = timing.name,
+			.track = ProfileTrack::Gpu,
+			.thread = 0,
+			.begin = timing.begin,
+			.end = timing.end,
+		});
+	}
+
 	RHICommandListRef commandList = driver->CreateCommandList();
-	RHIRenderTargetRef renderTarget = driver->BeginFrame();
 	commandList->Begin();
-	commandList->BeginRenderPass(renderTarget);
 
-	for (RenderableRef& obj : renderQueue) {
-		commandList->SetViewport(200,  200, 800, 600);
-		commandList->SetScissors(200,  200, 800, 600);
-		obj->Render(commandList);
+	if (gpuCulling) {
+		commandList->BeginRegion("GPU culling");
+		gpuCulling->Dispatch(commandList, Frustum::FromMatrix(viewUniforms.viewProj));
+		commandList->EndRegion();
+	}
+
+	{
+		MUFFIN_PROFILE_SCOPE("Sort");
+		renderQueue.Sort(glm::vec3(viewUniforms.position), *jobs);
+		buildBatches();
+	}
+
+	size_t chunkCount = std::min<size_t>(jobs->WorkerCount() + 1, batches.size() / MIN_BATCHES_PER_WORKER);
+
+	if (chunkCount <= 1) {
+		MUFFIN_PROFILE_SCOPE("Record");
+		commandList->BeginRenderPass(renderTarget, RenderPassContents::Inline);
+		bindView(commandList);
+		drawGpuCulled(commandList);
+		recordBatches(commandList, 0, batches.size(), instanceTransforms);
+		commandList->EndRenderPass();
+		commandList->End();
+		lastFrameStats = commandList->Stats();
+	} else {
+		MUFFIN_PROFILE_SCOPE("Record");
+		// Chunks are contiguous ranges of the sorted queue, executed in order, so the draw order is unchanged.
+		std::vector<RHICommandListRef> chunks;
+		JobCounter recordings;
+
+		for (size_t c = 0; c < chunkCount; c++) {
+			RHICommandListRef chunk = driver->CreateSecondaryCommandList(renderTarget);
+			size_t first = batches.size() * c / chunkCount;
+			size_t last = batches.size() * (c + 1) / chunkCount;
+
+			jobs->Run([this, chunk, c, first, last]() {
+				MUFFIN_PROFILE_SCOPE("Record chunk");
+				std::vector<glm::mat4> transforms;
+				chunk->Begin();
+				bindView(chunk);
+				if (c == 0) {
+					drawGpuCulled(chunk);
+				}
+				recordBatches(chunk, first, last, transforms);
+				chunk->End();
+			}, &recordings);
+			chunks.push_back(chunk);
+		}
+
+		jobs->Wait(recordings);
+
+		commandList->BeginRenderPass(renderTarget, RenderPassContents::SecondaryCommandLists);
+		commandList->ExecuteCommandLists(chunks);
+		commandList->EndRenderPass();
+		commandList->End();
+
+		lastFrameStats = commandList->Stats();
+		for (const RHICommandListRef& chunk : chunks) {
+			lastFrameStats += chunk->Stats();
+		}
 	}
 
-	commandList->EndRenderPass();
-	commandList->End();
-	driver->Submit(commandList);
-	driver->EndFrame();
+	{
+		MUFFIN_PROFILE_SCOPE("Submit");
+		driver->Submit(commandList);
+		driver->EndFrame();
+	}
 
-	renderQueue.clear();
+	renderQueue.Clear();
 }
+
+const CommandListStats& Renderer::LastFrameStats() const
+{
+	return lastFrameStats;
+}
+
+void Renderer::SetCamera(const Camera& camera)
+{
+	viewUniforms = camera.Uniforms();
+}
+
+void Renderer::SetGpuCulling(GpuCullingRef culling)
+{
+	gpuCulling = std::move(culling);
+}
\ No newline at end of file
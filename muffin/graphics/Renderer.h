@@ -1,19 +1,54 @@
 #pragma once
 
+#include "Camera.h"
+#include "GpuCulling.h"
+#include "RenderQueue.h"
 #include "Renderable.h"
+#include "muffin/core/JobSystem.h"
 #include "muffin/graphics/rhi/RHI.h"
 #include <vector>
 
 class Renderer
 {
 public:
-	Renderer(RHIDriverRef driver);
+	Renderer(RHIDriverRef driver, JobSystemRef jobs);
 
 	void Enqueue(RenderableRef obj);
 
 	void Render();
 
+	const CommandListStats& LastFrameStats() const;
+
+	// Snapshot of the camera for the next Render(); the camera itself is not referenced.
+	void SetCamera(const Camera& camera);
+
+	// Objects culled and drawn on the GPU each frame, before the queued renderables; null to disable.
+	void SetGpuCulling(GpuCullingRef culling);
+
 private:
+	// Consecutive queue entries [begin, end) recorded as a single draw.
+	struct Batch
+	{
+		size_t begin;
+		size_t end;
+	};
+
+	void buildBatches();
+
+	void bindView(const RHICommandListRef& commandList);
+
+	void setViewport(const RHICommandListRef& commandList);
+
+	void drawGpuCulled(const RHICommandListRef& commandList);
+
+	void recordBatches(const RHICommandListRef& commandList, size_t first, size_t last, std::vector<glm::mat4>& transforms);
+
 	RHIDriverRef driver;
-	std::vector<RenderableRef> renderQueue;
+	JobSystemRef jobs;
+	RenderQueue renderQueue;
+	ViewUniforms viewUniforms;
+	GpuCullingRef gpuCulling;
+	std::vector<Batch> batches;
+	std::vector<glm::mat4> instanceTransforms;
+	CommandListStats lastFrameStats;
 };
\ No newline at end of file
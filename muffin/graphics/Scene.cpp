@@ -1,21 +1,151 @@
 #include "Scene.h"
 
-void Scene::AddObject(RenderObjectRef object)
+#include <stdexcept>
+
+Scene::~Scene()
+{
+	for (const RenderObjectRef& obj : objects.Values()) {
+		obj->localTransform = transforms.Local(obj->transform);
+		obj->scene = nullptr;
+		obj->transform = NULL_TRANSFORM;
+		obj->proxy = BVH_NULL_NODE;
+	}
+}
+
+SlotHandle Scene::AddObject(RenderObjectRef object)
+{
+	if (object->scene) {
+		throw std::runtime_error("object already belongs to a scene");
+	}
+	if (names.contains(object->Name())) {
+		throw std::runtime_error("object name already used in scene: " + object->Name());
+	}
+
+	RenderObject& obj = *object;
+	SlotHandle handle = objects.Insert(std::move(object));
+	names.emplace(obj.Name(), handle);
+
+	obj.scene = this;
+	obj.transform = transforms.Create();
+	transforms.SetLocal(obj.transform, obj.localTransform);
+	if (obj.transform >= transformOwners.size()) {
+		transformOwners.resize(obj.transform + 1);
+	}
+	transformOwners[obj.transform] = handle.index;
+
+	obj.proxy = obj.mesh ? bvh.Insert(obj.WorldBox(), handle.index) : BVH_NULL_NODE;
+	return handle;
+}
+
+void Scene::RemoveObject(SlotHandle handle)
 {
-	objects.push_back(object);
+	RenderObjectRef* object = objects.Get(handle);
+	if (!object) {
+		return;
+	}
+
+	RenderObject& obj = **object;
+	if (obj.proxy != BVH_NULL_NODE) {
+		bvh.Remove(obj.proxy);
+	}
+	obj.localTransform = transforms.Local(obj.transform);
+	transforms.Destroy(obj.transform);
+	obj.scene = nullptr;
+	obj.transform = NULL_TRANSFORM;
+	obj.proxy = BVH_NULL_NODE;
+
+	names.erase(obj.Name());
+	objects.Remove(handle);
+}
+
+RenderObjectRef Scene::GetObject(SlotHandle handle)
+{
+	RenderObjectRef* object = objects.Get(handle);
+	return object ? *object : nullptr;
 }
 
 RenderObjectRef Scene::GetObject(const std::string& name)
 {
-	for (RenderObjectRef& obj : objects) {
-		if (obj->Name() == name) {
-			return obj;
+	return GetObject(FindObject(name));
+}
+
+SlotHandle Scene::FindObject(const std::string& name) const
+{
+	auto it = names.find(name);
+	return it != names.end() ? it->second : SlotHandle{};
+}
+
+const std::vector<RenderObjectRef>& Scene::GetObjects()
+{
+	return objects.Values();
+}
+
+void Scene::SetParent(SlotHandle child, SlotHandle parent)
+{
+	RenderObjectRef* childObject = objects.Get(child);
+	if (!childObject) {
+		return;
+	}
+
+	RenderObjectRef* parentObject = objects.Get(parent);
+	transforms.SetParent((*childObject)->transform, parentObject ? (*parentObject)->transform : NULL_TRANSFORM);
+}
+
+const std::vector<TransformId>& Scene::Update()
+{
+	const std::vector<TransformId>& changed = transforms.Update();
+	for (TransformId id : changed) {
+		RenderObject& obj = *objects.AtSlot(transformOwners[id]);
+		if (obj.proxy != BVH_NULL_NODE) {
+			bvh.Move(obj.proxy, obj.WorldBox());
 		}
 	}
-	return nullptr;
+	return changed;
 }
 
-const std::vector<RenderObjectRef>& Scene::GetObjects()
+void Scene::Cull(const Frustum& frustum, std::vector<RenderObjectRef>& visible)
 {
-	return objects;
-}
\ No newline at end of file
+	visibleIndices.clear();
+	candidateIndices.clear();
+	bvh.QueryFrustum(frustum, visibleIndices, candidateIndices);
+
+	candidateSpheres.Resize(candidateIndices.size());
+	for (size_t i = 0; i < candidateIndices.size(); i++) {
+		candidateSpheres.Set(i, objects.AtSlot(candidateIndices[i])->WorldBounds());
+	}
+
+	candidateHits.clear();
+	CullSpheres(frustum, candidateSpheres, candidateHits);
+	for (uint32_t i : candidateHits) {
+		visibleIndices.push_back(candidateIndices[i]);
+	}
+
+	for (uint32_t i : visibleIndices) {
+		visible.push_back(objects.AtSlot(i));
+	}
+}
+
+RenderObjectRef Scene::Pick(const glm::vec3& origin, const glm::vec3& direction, float maxDistance)
+{
+	glm::vec3 invDirection(1.f / direction.x, 1.f / direction.y, 1.f / direction.z);
+
+	auto hitTest = [&](uint32_t i, float maxT) { return objects.AtSlot(i)->WorldBox().RayDistance(origin, invDirection, maxT); };
+
+	uint32_t hit;
+	float distance;
+	if (!bvh.RayCast(origin, direction, maxDistance, hitTest, hit, distance)) {
+		return nullptr;
+	}
+	return objects.AtSlot(hit);
+}
+
+RenderObjectRef Scene::Nearest(const glm::vec3& point)
+{
+	auto distance2 = [&](uint32_t i) { return objects.AtSlot(i)->WorldBox().Distance2(point); };
+
+	uint32_t nearest;
+	if (!bvh.Nearest(point, distance2, nearest)) {
+		return nullptr;
+	}
+	return objects.AtSlot(nearest);
+}
@@ -1,18 +1,69 @@
 #pragma once
 
+#include "Culling.h"
+#include "DynamicBVH.h"
 #include "RenderObject.h"
+#include "TransformStore.h"
+#include "muffin/core/SlotMap.h"
 
+#include <limits>
 #include <string>
+#include <unordered_map>
 
 class Scene
 {
 public:
-	void AddObject(RenderObjectRef object);
+	~Scene();
+
+	// Object names must be unique within a scene.
+	SlotHandle AddObject(RenderObjectRef object);
+
+	void RemoveObject(SlotHandle handle);
+
+	// Returns nullptr for handles of removed objects.
+	RenderObjectRef GetObject(SlotHandle handle);
 
 	RenderObjectRef GetObject(const std::string& name);
 
+	SlotHandle FindObject(const std::string& name) const;
+
+	// Makes child's transform relative to parent's; an invalid parent handle makes it a root again.
+	void SetParent(SlotHandle child, SlotHandle parent);
+
+	// Recomputes world matrices changed since the last call and refits their bounds. Call once per frame,
+	// before culling. Returns the recomputed transforms, valid until the next call.
+	const std::vector<TransformId>& Update();
+
+	// Densely packed; order changes when objects are removed.
 	const std::vector<RenderObjectRef>& GetObjects();
 
+	// Appends the objects whose world bounds intersect frustum.
+	void Cull(const Frustum& frustum, std::vector<RenderObjectRef>& visible);
+
+	// Closest object whose world box the ray hits, or nullptr.
+	RenderObjectRef Pick(const glm::vec3& origin, const glm::vec3& direction,
+		float maxDistance = std::numeric_limits<float>::max());
+
+	// Object whose world box is closest to point, or nullptr if the scene is empty.
+	RenderObjectRef Nearest(const glm::vec3& point);
+
 private:
-	std::vector<RenderObjectRef> objects;
-};
\ No newline at end of file
+	friend class RenderObject;
+
+	SlotMap<RenderObjectRef> objects;
+
+	TransformStore transforms;
+	// Slot index of the object owning each transform.
+	std::vector<uint32_t> transformOwners;
+
+	std::unordered_map<std::string, SlotHandle> names;
+
+	// Leaves hold slot indices into objects; objects without a mesh have no bounds and are left out.
+	DynamicBVH bvh;
+	std::vector<uint32_t> visibleIndices;
+
+	// Leaves the BVH could not decide, tested by their world spheres in one CullSpheres pass.
+	std::vector<uint32_t> candidateIndices;
+	BoundingSphereArray candidateSpheres;
+	std::vector<uint32_t> candidateHits;
+};
@@ -0,0 +1,210 @@
+#include "TransformStore.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+// out = a * b for column-major matrices: each output column is a combination of a's columns.
+static void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+{
+#if defined(__SSE__)
+	__m128 a0 = _mm_loadu_ps(&a[0][0]);
+	__m128 a1 = _mm_loadu_ps(&a[1][0]);
+	__m128 a2 = _mm_loadu_ps(&a[2][0]);
+	__m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+	for (int j = 0; j < 4; j++) {
+		__m128 column = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b[j][0])), _mm_mul_ps(a1, _mm_set1_ps(b[j][1]))),
+			_mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(b[j][2])), _mm_mul_ps(a3, _mm_set1_ps(b[j][3]))));
+		_mm_storeu_ps(&out[j][0], column);
+	}
+#else
+	out = a * b;
+#endif
+}
+
+TransformId TransformStore::Create(TransformId parentId)
+{
+	TransformId id;
+	if (!freeIds.empty()) {
+		id = freeIds.back();
+		freeIds.pop_back();
+	} else {
+		id = local.size();
+		local.emplace_back();
+		world.emplace_back();
+		parent.push_back(NULL_TRANSFORM);
+		firstChild.push_back(NULL_TRANSFORM);
+		nextSibling.push_back(NULL_TRANSFORM);
+		depth.push_back(0);
+		dirty.push_back(0);
+		alive.push_back(0);
+	}
+
+	local[id] = glm::mat4(1.f);
+	world[id] = glm::mat4(1.f);
+	parent[id] = NULL_TRANSFORM;
+	firstChild[id] = NULL_TRANSFORM;
+	nextSibling[id] = NULL_TRANSFORM;
+	depth[id] = 0;
+	dirty[id] = 0;
+	alive[id] = 1;
+
+	if (parentId != NULL_TRANSFORM) {
+		SetParent(id, parentId);
+	}
+	markDirty(id);
+	return id;
+}
+
+void TransformStore::Destroy(TransformId id)
+{
+	detach(id);
+
+	TransformId child = firstChild[id];
+	while (child != NULL_TRANSFORM) {
+		TransformId next = nextSibling[child];
+		parent[child] = NULL_TRANSFORM;
+		nextSibling[child] = NULL_TRANSFORM;
+		updateDepth(child);
+		markDirty(child);
+		child = next;
+	}
+
+	firstChild[id] = NULL_TRANSFORM;
+	alive[id] = 0;
+	freeIds.push_back(id);
+}
+
+void TransformStore::SetLocal(TransformId id, const glm::mat4& matrix)
+{
+	local[id] = matrix;
+	markDirty(id);
+}
+
+const glm::mat4& TransformStore::Local(TransformId id) const
+{
+	return local[id];
+}
+
+const glm::mat4& TransformStore::World(TransformId id) const
+{
+	return world[id];
+}
+
+TransformId TransformStore::Parent(TransformId id) const
+{
+	return parent[id];
+}
+
+void TransformStore::SetParent(TransformId id, TransformId parentId)
+{
+	for (TransformId p = parentId; p != NULL_TRANSFORM; p = parent[p]) {
+		if (p == id) {
+			throw std::runtime_error("transform cannot be parented to its own descendant");
+		}
+	}
+
+	detach(id);
+
+	parent[id] = parentId;
+	if (parentId != NULL_TRANSFORM) {
+		nextSibling[id] = firstChild[parentId];
+		firstChild[parentId] = id;
+	}
+
+	updateDepth(id);
+	markDirty(id);
+}
+
+void TransformStore::detach(TransformId id)
+{
+	TransformId p = parent[id];
+	if (p == NULL_TRANSFORM) {
+		return;
+	}
+
+	TransformId* link = &firstChild[p];
+	while (*link != id) {
+		link = &nextSibling[*link];
+	}
+	*link = nextSibling[id];
+
+	parent[id] = NULL_TRANSFORM;
+	nextSibling[id] = NULL_TRANSFORM;
+}
+
+void TransformStore::updateDepth(TransformId id)
+{
+	depth[id] = parent[id] == NULL_TRANSFORM ? 0 : depth[parent[id]] + 1;
+	for (TransformId child = firstChild[id]; child != NULL_TRANSFORM; child = nextSibling[child]) {
+		updateDepth(child);
+	}
+}
+
+void TransformStore::markDirty(TransformId id)
+{
+	if (!dirty[id]) {
+		dirty[id] = 1;
+		dirtyIds.push_back(id);
+	}
+}
+
+void TransformStore::computeWorld(const std::vector<TransformId>& batch)
+{
+	for (TransformId id : batch) {
+		if (parent[id] == NULL_TRANSFORM) {
+			world[id] = local[id];
+		} else {
+			multiply(world[parent[id]], local[id], world[id]);
+		}
+	}
+}
+
+const std::vector<TransformId>& TransformStore::Update()
+{
+	changed.clear();
+
+	// Destroyed transforms may still be queued.
+	std::erase_if(dirtyIds, [this](TransformId id) {
+		if (!alive[id]) {
+			dirty[id] = 0;
+		}
+		return !alive[id];
+	});
+
+	std::sort(dirtyIds.begin(), dirtyIds.end(), [this](TransformId a, TransformId b) { return depth[a] < depth[b]; });
+
+	// dirty is cleared as transforms are scheduled, so a transform reached through a dirty ancestor is not scheduled twice.
+	size_t next = 0;
+	level.clear();
+	while (!level.empty() || next < dirtyIds.size()) {
+		uint32_t levelDepth = level.empty() ? depth[dirtyIds[next]] : depth[level[0]];
+
+		while (next < dirtyIds.size() && depth[dirtyIds[next]] == levelDepth) {
+			TransformId id = dirtyIds[next++];
+			if (dirty[id]) {
+				dirty[id] = 0;
+				level.push_back(id);
+			}
+		}
+
+		computeWorld(level);
+		changed.insert(changed.end(), level.begin(), level.end());
+
+		nextLevel.clear();
+		for (TransformId id : level) {
+			for (TransformId child = firstChild[id]; child != NULL_TRANSFORM; child = nextSibling[child]) {
+				dirty[child] = 0;
+				nextLevel.push_back(child);
+			}
+		}
+		level.swap(nextLevel);
+	}
+
+	dirtyIds.clear();
+	return changed;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+using TransformId = uint32_t;
+
+const TransformId NULL_TRANSFORM = UINT32_MAX;
+
+// Local and world matrices for a hierarchy of transforms, one array per field. Setting a local
+// matrix only marks it dirty; Update() then recomputes the world matrices of dirty transforms and
+// their descendants level by level, so every parent is final before its children are multiplied.
+class TransformStore
+{
+public:
+	TransformId Create(TransformId parent = NULL_TRANSFORM);
+
+	// Children of a destroyed transform become roots and keep their local matrices.
+	void Destroy(TransformId id);
+
+	void SetLocal(TransformId id, const glm::mat4& local);
+
+	const glm::mat4& Local(TransformId id) const;
+
+	// Valid after the Update() following the last change.
+	const glm::mat4& World(TransformId id) const;
+
+	void SetParent(TransformId id, TransformId parent);
+
+	TransformId Parent(TransformId id) const;
+
+	// Returns the transforms whose world matrix was recomputed, valid until the next call.
+	const std::vector<TransformId>& Update();
+
+private:
+	void markDirty(TransformId id);
+
+	void updateDepth(TransformId id);
+
+	void detach(TransformId id);
+
+	void computeWorld(const std::vector<TransformId>& batch);
+
+	std::vector<glm::mat4> local;
+	std::vector<glm::mat4> world;
+	std::vector<TransformId> parent;
+	std::vector<TransformId> firstChild;
+	std::vector<TransformId> nextSibling;
+	std::vector<uint32_t> depth;
+	std::vector<uint8_t> dirty;
+	std::vector<uint8_t> alive;
+
+	std::vector<TransformId> freeIds;
+	std::vector<TransformId> dirtyIds;
+	std::vector<TransformId> changed;
+	std::vector<TransformId> level;
+	std::vector<TransformId> nextLevel;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <compare>
 #include <map>
 #include <memory>
 #include <vector>
@@ -12,6 +13,11 @@ enum class BufferUsage
 	Index,
 	Uniform,
 	Staging,
+	Storage,
+	// Draw arguments for the DrawIndexedIndirect* calls; can also be written with UpdateBuffer.
+	Indirect,
+	// Host-visible destination of GPU copies, for reading results back on the CPU.
+	Readback,
 };
 
 enum VertexElementType
@@ -42,9 +48,20 @@ enum VertexElementType
 	NumBits = 5,
 };
 
+// Vertex shader inputs whose name starts with INSTANCE_INPUT_PREFIX advance per instance and are
+// read from the buffer bound at INSTANCE_BUFFER_BINDING.
+const char* const INSTANCE_INPUT_PREFIX = "instance";
+const int INSTANCE_BUFFER_BINDING = 8;
+
 struct BufferInfo
 {
 	BufferUsage usage;
+	// Dynamic vertex/index buffers are rewritten by the CPU and stay host-visible,
+	// static ones live in device-local memory and are filled through staging uploads. Static buffers can be
+	// both source and destination of RHICommandList::CopyBuffer.
+	bool dynamic{ false };
+	// Also bindable as a storage buffer, so shaders (e.g. compute) can write it.
+	bool shaderWrite{ false };
 };
 
 class RHIResource
@@ -58,7 +75,9 @@ class RHIBuffer : public RHIResource
 public:
 	virtual ~RHIBuffer() override = default;
 
-	virtual void Write(void* data, uint32_t size) = 0;
+	// Writes [offset, offset + size). Static buffers are filled through the upload queue, so the bytes become
+	// visible to frames submitted afterwards; ranges that in-flight frames still read must not be rewritten.
+	virtual void Write(const void* data, uint32_t size, uint32_t offset = 0) = 0;
 };
 
 class RHITexture : public RHIResource
@@ -73,6 +92,9 @@ class RHISampler : public RHIResource
 
 using RHISamplerRef = std::shared_ptr<RHISampler>;
 
+// Slot of a resource in the driver's bindless tables, passed to shaders (e.g. as a push constant).
+using BindlessIndex = uint32_t;
+
 class RHIGraphicsPipeline
 {
 public:
@@ -81,10 +103,19 @@ public:
 
 using RHIGraphicsPipelineRef = std::shared_ptr<RHIGraphicsPipeline>;
 
+class RHIComputePipeline
+{
+public:
+	virtual ~RHIComputePipeline() = default;
+};
+
+using RHIComputePipelineRef = std::shared_ptr<RHIComputePipeline>;
+
 enum class ShaderType
 {
 	Vertex,
-	Fragment
+	Fragment,
+	Compute
 };
 
 struct RHIShader : RHIResource
@@ -99,9 +130,13 @@ class RHIRenderTarget
 
 using RHIRenderTargetRef = std::shared_ptr<RHIRenderTarget>;
 
+// The pipeline create infos and their parts compare member by member, shaders by identity, so that the driver
+// can hand out one pipeline for equal create infos. New members are picked up by the defaulted comparisons.
 struct DepthStencilInfo
 {
 	bool depthTestEnable{ false };
+
+	auto operator<=>(const DepthStencilInfo& other) const = default;
 };
 
 enum class CullMode
@@ -121,6 +156,8 @@ struct RasterizerInfo
 {
 	CullMode cullMode{ CullMode::Back };
 	FaceOrientation faceOrientation{ FaceOrientation::CounterClockwise };
+
+	auto operator<=>(const RasterizerInfo& other) const = default;
 };
 
 struct GraphicsPipelineCreateInfo
@@ -129,11 +166,118 @@ struct GraphicsPipelineCreateInfo
 	RHIShaderRef fragmentShader;
 	DepthStencilInfo depthStencil;
 	RasterizerInfo rasterizer;
+
+	auto operator<=>(const GraphicsPipelineCreateInfo& other) const = default;
 };
 
+struct ComputePipelineCreateInfo
+{
+	RHIShaderRef computeShader;
+
+	auto operator<=>(const ComputePipelineCreateInfo& other) const = default;
+};
+
+// Layout of one entry in an indirect buffer, as read by DrawIndexedIndirect*.
+struct DrawIndexedIndirectCommand
+{
+	uint32_t indexCount;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t vertexOffset;
+	uint32_t firstInstance;
+};
+
+// Workgroup counts read by DispatchIndirect.
+struct DispatchIndirectCommand
+{
+	uint32_t groupCountX;
+	uint32_t groupCountY;
+	uint32_t groupCountZ;
+};
+
+// Work that a barrier orders, each with the memory accesses it makes. Barriers cover buffers and storage
+// textures alike: storage textures never change layout, so a memory dependency is all they need.
+enum BarrierScope : uint32_t
+{
+	BarrierTransfer = 1 << 0,
+	BarrierCompute = 1 << 1,
+	// Indirect draw and dispatch arguments.
+	BarrierIndirect = 1 << 2,
+	BarrierVertexInput = 1 << 3,
+	BarrierGraphicsShaders = 1 << 4,
+	BarrierColorAttachment = 1 << 5,
+};
+
+using BarrierScopeFlags = uint32_t;
+
 using RHIBufferRef = std::shared_ptr<RHIBuffer>;
 using RHIResourceRef = std::shared_ptr<RHIResource>;
 
+struct CommandListStats
+{
+	uint64_t draws{ 0 };
+	uint64_t instances{ 0 };
+	// Of direct draws only; indirect draw arguments are not known on the CPU.
+	uint64_t triangles{ 0 };
+	uint64_t pipelineBinds{ 0 };
+	uint64_t pipelineBindsSkipped{ 0 };
+	uint64_t vertexBufferBinds{ 0 };
+	uint64_t vertexBufferBindsSkipped{ 0 };
+	uint64_t indexBufferBinds{ 0 };
+	uint64_t indexBufferBindsSkipped{ 0 };
+	uint64_t descriptorSetBinds{ 0 };
+	uint64_t descriptorSetBindsSkipped{ 0 };
+	uint64_t viewportSets{ 0 };
+	uint64_t viewportSetsSkipped{ 0 };
+	uint64_t scissorSets{ 0 };
+	uint64_t scissorSetsSkipped{ 0 };
+	uint64_t pushConstants{ 0 };
+	// Indirect draw commands recorded; the number of draws they issue is decided on the GPU.
+	uint64_t indirectDraws{ 0 };
+	uint64_t dispatches{ 0 };
+
+	CommandListStats& operator+=(const CommandListStats& other)
+	{
+		draws += other.draws;
+		instances += other.instances;
+		triangles += other.triangles;
+		pipelineBinds += other.pipelineBinds;
+		pipelineBindsSkipped += other.pipelineBindsSkipped;
+		vertexBufferBinds += other.vertexBufferBinds;
+		vertexBufferBindsSkipped += other.vertexBufferBindsSkipped;
+		indexBufferBinds += other.indexBufferBinds;
+		indexBufferBindsSkipped += other.indexBufferBindsSkipped;
+		descriptorSetBinds += other.descriptorSetBinds;
+		descriptorSetBindsSkipped += other.descriptorSetBindsSkipped;
+		viewportSets += other.viewportSets;
+		viewportSetsSkipped += other.viewportSetsSkipped;
+		scissorSets += other.scissorSets;
+		scissorSetsSkipped += other.scissorSetsSkipped;
+		pushConstants += other.pushConstants;
+		indirectDraws += other.indirectDraws;
+		dispatches += other.dispatches;
+		return *this;
+	}
+};
+
+enum class RenderPassContents
+{
+	Inline,
+	SecondaryCommandLists
+};
+
+// A region timed with RHICommandList::BeginRegion/EndRegion, in nanoseconds on the device's timestamp clock.
+struct GpuTiming
+{
+	const char* name;
+	uint64_t begin;
+	uint64_t end;
+};
+
+class RHICommandList;
+
+using RHICommandListRef = std::shared_ptr<RHICommandList>;
+
 class RHICommandList : public RHIResource
 {
 public:
@@ -143,27 +287,129 @@ public:
 
 	virtual void BindPipeline(const RHIGraphicsPipelineRef& pipeline) = 0;
 
-	virtual void BeginRenderPass(const RHIRenderTargetRef& renderTarget) = 0;
+	// Compute and graphics pipelines are bound independently; push constants go to whichever was bound last.
+	virtual void BindComputePipeline(const RHIComputePipelineRef& pipeline) = 0;
+
+	virtual void BeginRenderPass(const RHIRenderTargetRef& renderTarget, RenderPassContents contents) = 0;
 
 	virtual void EndRenderPass() = 0;
 
+	// Times the GPU work recorded up to the matching EndRegion; regions nest. The name is not copied, so pass
+	// a string literal. Render passes are timed as "Render pass" without asking. No-op when the device has no
+	// timestamp support.
+	virtual void BeginRegion(const char* name) = 0;
+
+	virtual void EndRegion() = 0;
+
 	virtual void BindVertexBuffer(const RHIBufferRef& buf, int binding) = 0;
 
 	virtual void BindIndexBuffer(const RHIBufferRef& buf) = 0;
 
+	virtual void BindVertexData(const void* data, uint32_t size, int binding) = 0;
+
+	// Copies 16-bit indices into per-frame memory and binds them, like BindVertexData.
+	virtual void BindIndexData(const void* data, uint32_t size) = 0;
+
+	// Named bindings stay in effect until the list ends or executes secondaries, including across
+	// BindPipeline: bind per-pass data (e.g. the camera) once and every later pipeline using that name sees it.
 	virtual void BindUniformBuffer(const std::string& name, const RHIBufferRef& buffer, int size) = 0;
 
+	virtual void BindUniformData(const std::string& name, const void* data, uint32_t size) = 0;
+
 	virtual void BindTexture(const std::string& name, const RHITextureRef& texture, const RHISamplerRef& sampler) = 0;
 
+	// buffer must be BufferUsage::Storage or have BufferInfo::shaderWrite.
+	virtual void BindStorageBuffer(const std::string& name, const RHIBufferRef& buffer) = 0;
+
+	// Copies data into per-frame memory, like BindUniformData, for shader inputs too large for a uniform block.
+	virtual void BindStorageData(const std::string& name, const void* data, uint32_t size) = 0;
+
+	// Storage textures are read and written by shaders in the same image layout; see RHIDriver::CreateStorageTexture.
+	virtual void BindStorageImage(const std::string& name, const RHITextureRef& texture) = 0;
+
+	// Writes up to 64 KiB into buffer from the command stream; outside render passes. Offset and size must be
+	// multiples of 4.
+	virtual void UpdateBuffer(const RHIBufferRef& buffer, uint32_t offset, const void* data, uint32_t size) = 0;
+
+	// Copies size bytes between static buffers on the GPU; outside render passes.
+	virtual void CopyBuffer(const RHIBufferRef& src, uint32_t srcOffset, const RHIBufferRef& dst, uint32_t dstOffset,
+		uint32_t size) = 0;
+
+	// Makes the memory writes of the work in before visible to the work in after, e.g.
+	// Barrier(BarrierCompute, BarrierIndirect | BarrierVertexInput) between culling and drawing. Outside render passes.
+	virtual void Barrier(BarrierScopeFlags before, BarrierScopeFlags after) = 0;
+
+	virtual void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) = 0;
+
+	// Reads a DispatchIndirectCommand from buffer, e.g. written by an earlier pass sizing the next one's work.
+	virtual void DispatchIndirect(const RHIBufferRef& buffer, uint32_t offset) = 0;
+
+	// Writes bytes [offset, offset + size) of the bound pipeline's push constant blocks, for small per-draw
+	// data that should not go through descriptor sets. Offset and size must be multiples of 4.
+	virtual void PushConstants(uint32_t offset, uint32_t size, const void* data) = 0;
+
 	virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset,
 		uint32_t firstInstance) = 0;
 
+	// Reads drawCount DrawIndexedIndirectCommands from buffer, stride bytes apart. drawCount > 1 requires
+	// RHIDriver::SupportsMultiDrawIndirect.
+	virtual void DrawIndexedIndirect(const RHIBufferRef& buffer, uint32_t offset, uint32_t drawCount, uint32_t stride) = 0;
+
+	// Like DrawIndexedIndirect, with the draw count read from countBuffer on the GPU (at most maxDrawCount).
+	// Requires RHIDriver::SupportsDrawIndirectCount.
+	virtual void DrawIndexedIndirectCount(const RHIBufferRef& buffer, uint32_t offset, const RHIBufferRef& countBuffer,
+		uint32_t countOffset, uint32_t maxDrawCount, uint32_t stride) = 0;
+
 	virtual void SetViewport(float offsetX, float offsetY, float width, float height) = 0;
 
 	virtual void SetScissors(int32_t offsetX, int32_t offsetY, uint32_t width, uint32_t height) = 0;
+
+	// Only valid inside a render pass begun with RenderPassContents::SecondaryCommandLists.
+	virtual void ExecuteCommandLists(const std::vector<RHICommandListRef>& commandLists) = 0;
+
+	virtual const CommandListStats& Stats() const = 0;
 };
 
-using RHICommandListRef = std::shared_ptr<RHICommandList>;
+struct MemoryStats
+{
+	uint64_t reservedBytes{ 0 };
+	uint64_t usedBytes{ 0 };
+	uint32_t blockCount{ 0 };
+	uint32_t allocationCount{ 0 };
+	float fragmentation{ 0.f };
+};
+
+// A rendered frame in host memory: width * height sRGB-encoded RGBA8 pixels, rows tightly packed, top row first.
+struct FrameImage
+{
+	uint32_t width{ 0 };
+	uint32_t height{ 0 };
+	std::vector<uint8_t> pixels;
+};
+
+// Driver-wide counters, either for one frame (from one BeginFrame to the next) or since the driver was created.
+struct RHIStats
+{
+	// Recorded into the command lists submitted, secondaries included.
+	CommandListStats commands;
+	uint64_t submits{ 0 };
+	// Times the CPU blocked on the GPU: frame fences in BeginFrame, upload waits and device idle waits.
+	uint64_t fenceWaits{ 0 };
+	uint64_t fenceWaitNs{ 0 };
+	uint64_t descriptorSetsAllocated{ 0 };
+	// vkAllocateMemory/vkFreeMemory calls; buffers and textures are sub-allocated from these blocks.
+	uint64_t memoryAllocations{ 0 };
+	uint64_t memoryFrees{ 0 };
+	uint64_t buffersCreated{ 0 };
+	uint64_t buffersDestroyed{ 0 };
+	uint64_t bufferBytesCreated{ 0 };
+	uint64_t bufferBytesFreed{ 0 };
+	// All images the driver creates, including depth and offscreen targets.
+	uint64_t texturesCreated{ 0 };
+	uint64_t texturesDestroyed{ 0 };
+	uint64_t textureBytesCreated{ 0 };
+	uint64_t textureBytesFreed{ 0 };
+};
 
 class RHIDriver
 {
@@ -174,10 +420,18 @@ public:
 
 	virtual RHIBufferRef CreateBuffer(size_t size, const BufferInfo& info) = 0;
 
+	// Equal create infos get the same pipeline back while it is still referenced.
 	virtual RHIGraphicsPipelineRef CreateGraphicsPipeline(const GraphicsPipelineCreateInfo& info) = 0;
 
+	// Shared like graphics pipelines.
+	virtual RHIComputePipelineRef CreateComputePipeline(const ComputePipelineCreateInfo& info) = 0;
+
 	virtual RHICommandListRef CreateCommandList() = 0;
 
+	// Secondary lists continue the render pass of renderTarget. They must be created on the
+	// render thread, but each one can then be recorded on its own worker thread.
+	virtual RHICommandListRef CreateSecondaryCommandList(const RHIRenderTargetRef& renderTarget) = 0;
+
 	virtual void Submit(RHICommandListRef& commandList) = 0;
 
 	virtual void WaitIdle() = 0;
@@ -186,13 +440,62 @@ public:
 
 	virtual RHIRenderTargetRef BeginFrame() = 0;
 
+	// Number of the frame being recorded, incremented by BeginFrame; may be read from any thread. Whatever the
+	// frame numbered N used is no longer read by the GPU once FrameNumber() - N >= FramesInFlight().
+	virtual uint64_t FrameNumber() = 0;
+
+	virtual uint32_t FramesInFlight() = 0;
+
 	virtual void EndFrame() = 0;
 
+	// Headless drivers only: copies the frame last ended with EndFrame to host memory. Waits for the device
+	// to go idle, so it is meant for capturing images rather than for every frame.
+	virtual void ReadbackFrame(FrameImage& image) = 0;
+
 	virtual RHITextureRef CreateTexture(uint32_t width, uint32_t height) = 0;
 
+	// RGBA8 (unorm) texture that shaders can write with BindStorageImage as well as sample with BindTexture.
+	virtual RHITextureRef CreateStorageTexture(uint32_t width, uint32_t height) = 0;
+
 	virtual RHISamplerRef CreateSampler() = 0;
 
 	virtual void CopyBufferToTexture(const RHIBufferRef& buf, RHITextureRef& image, uint32_t width, uint32_t height) = 0;
+
+	virtual MemoryStats GetMemoryStats() = 0;
+
+	// Counters of the last completed frame.
+	virtual RHIStats FrameStats() = 0;
+
+	// Counters since the driver was created, including the frame in progress.
+	virtual RHIStats TotalStats() = 0;
+
+	// Regions of the most recent frame the GPU has finished, read in BeginFrame without waiting, so they lag
+	// the frame being recorded by the number of frames in flight. Empty without timestamp support.
+	virtual const std::vector<GpuTiming>& GpuTimings() = 0;
+
+	virtual bool SupportsDrawIndirectCount() = 0;
+
+	// DrawIndexedIndirect with drawCount > 1.
+	virtual bool SupportsMultiDrawIndirect() = 0;
+
+	// Indirect draw commands with a non-zero firstInstance.
+	virtual bool SupportsDrawIndirectFirstInstance() = 0;
+
+	// Bindless mode: every registered texture and storage buffer is reachable through one descriptor set
+	// that shaders declare as runtime arrays and that stays bound, so draws select resources by index.
+	// Optional; the Register/Release calls throw when it is not supported.
+	virtual bool SupportsBindless() = 0;
+
+	// The index stays valid, and the resource alive, until it is released.
+	virtual BindlessIndex RegisterBindlessTexture(const RHITextureRef& texture, const RHISamplerRef& sampler) = 0;
+
+	// buffer must have BufferUsage::Storage.
+	virtual BindlessIndex RegisterBindlessBuffer(const RHIBufferRef& buffer) = 0;
+
+	// The slot is reused only after frames that may still read it have finished.
+	virtual void ReleaseBindlessTexture(BindlessIndex index) = 0;
+
+	virtual void ReleaseBindlessBuffer(BindlessIndex index) = 0;
 };
 
 using RHIDriverRef = std::shared_ptr<RHIDriver>;
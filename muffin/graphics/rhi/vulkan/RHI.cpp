@@ -1,7 +1,12 @@
 #include "RHI.h"
 #include "VulkanRHI.h"
 
-RHIDriverRef CreateVulkanRhi()
+RHIDriverRef CreateVulkanRhi(bool validation)
 {
-	return RHIDriverRef(new VulkanRHI());
+	return RHIDriverRef(new VulkanRHI(validation));
+}
+
+RHIDriverRef CreateHeadlessVulkanRhi(uint32_t width, uint32_t height, bool validation)
+{
+	return RHIDriverRef(new VulkanRHI(width, height, validation));
 }
\ No newline at end of file
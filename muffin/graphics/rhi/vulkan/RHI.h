@@ -2,4 +2,10 @@
 
 #include "muffin/graphics/rhi/RHI.h"
 
-RHIDriverRef CreateVulkanRhi();
+// validation turns on the Khronos validation layer, which must then be installed. It is off by default: the
+// layer costs far more CPU time than the renderer does.
+RHIDriverRef CreateVulkanRhi(bool validation = false);
+
+// No window or swapchain; frames are rendered into width x height offscreen images and can be read back with
+// ReadbackFrame. Runs on any Vulkan device, including software rasterizers such as lavapipe.
+RHIDriverRef CreateHeadlessVulkanRhi(uint32_t width, uint32_t height, bool validation = false);
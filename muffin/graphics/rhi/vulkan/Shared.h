@@ -1,6 +1,13 @@
 #pragma once
 
-#define VULKAN_RHI_SAFE_CALL(Result)   \
-	do {                               \
-		if ((Result) != VK_SUCCESS) {} \
+#include <stdexcept>
+#include <string>
+
+// Throws when the call does not return VK_SUCCESS, so that a failed creation surfaces as an error rather than
+// as an uninitialised handle.
+#define VULKAN_RHI_SAFE_CALL(Result)                                                    \
+	do {                                                                                \
+		if ((Result) != VK_SUCCESS) {                                                   \
+			throw std::runtime_error(std::string("Vulkan call failed: ") + #Result);    \
+		}                                                                               \
 	} while (0)
@@ -0,0 +1,224 @@
+#include "VulkanBindlessTable.h"
+#include "Shared.h"
+#include "VulkanBuffer.h"
+#include "VulkanImage.h"
+#include "VulkanSampler.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+VulkanBindlessTable::VulkanBindlessTable(VulkanDeviceRef device, uint32_t framesInFlight)
+	: device(device), framesInFlight(framesInFlight), currentFrame(0)
+{
+	VkPhysicalDeviceVulkan12Properties vulkan12Properties{};
+	vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &vulkan12Properties;
+	vkGetPhysicalDeviceProperties2(device->PhysicalDevice(), &properties);
+
+	// Both arrays are visible to every graphics stage and to compute, so they share the per-stage resource limit.
+	uint32_t perStage = vulkan12Properties.maxPerStageUpdateAfterBindResources;
+	textures.capacity = std::min({ BINDLESS_MAX_TEXTURES, perStage / 2,
+		vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+		vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages });
+	buffers.capacity = std::min({ BINDLESS_MAX_BUFFERS, perStage / 2,
+		vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+		vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageBuffers });
+
+	textures.resources.resize(textures.capacity);
+	textures.samplers.resize(textures.capacity);
+	buffers.resources.resize(buffers.capacity);
+	textures.retiring.resize(textures.capacity);
+	buffers.retiring.resize(buffers.capacity);
+
+	VkDescriptorSetLayoutBinding bindings[2]{};
+	bindings[0].binding = BINDLESS_TEXTURE_BINDING;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[0].descriptorCount = textures.capacity;
+	bindings[0].stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[1].binding = BINDLESS_BUFFER_BINDING;
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[1].descriptorCount = buffers.capacity;
+	bindings[1].stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+
+	// Empty slots are never read, and slots are rewritten while the set is bound by in-flight frames.
+	VkDescriptorBindingFlags flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+		VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+	VkDescriptorBindingFlags bindingFlags[2] = { flags, flags };
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+	flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	flagsInfo.bindingCount = 2;
+	flagsInfo.pBindingFlags = bindingFlags;
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = 2;
+	layoutInfo.pBindings = bindings;
+	layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layoutInfo.pNext = &flagsInfo;
+
+	VULKAN_RHI_SAFE_CALL(vkCreateDescriptorSetLayout(device->Device(), &layoutInfo, nullptr, &layout));
+
+	VkDescriptorPoolSize poolSizes[2];
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSizes[0].descriptorCount = textures.capacity;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSizes[1].descriptorCount = buffers.capacity;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = 2;
+	poolInfo.pPoolSizes = poolSizes;
+	poolInfo.maxSets = 1;
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolInfo.pNext = nullptr;
+
+	VULKAN_RHI_SAFE_CALL(vkCreateDescriptorPool(device->Device(), &poolInfo, nullptr, &pool));
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = pool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &layout;
+	allocInfo.pNext = nullptr;
+
+	VULKAN_RHI_SAFE_CALL(vkAllocateDescriptorSets(device->Device(), &allocInfo, &set));
+	device->Counters().descriptorSetsAllocated++;
+
+	// Handed out lowest first.
+	for (uint32_t i = textures.capacity; i > 0; i--) {
+		textures.freeSlots.push_back(i - 1);
+	}
+	for (uint32_t i = buffers.capacity; i > 0; i--) {
+		buffers.freeSlots.push_back(i - 1);
+	}
+}
+
+VulkanBindlessTable::~VulkanBindlessTable()
+{
+	vkDestroyDescriptorPool(device->Device(), pool, nullptr);
+	vkDestroyDescriptorSetLayout(device->Device(), layout, nullptr);
+}
+
+VkDescriptorSetLayout VulkanBindlessTable::Layout() const
+{
+	return layout;
+}
+
+VkDescriptorSet VulkanBindlessTable::Set() const
+{
+	return set;
+}
+
+BindlessIndex VulkanBindlessTable::allocate(Table& table, const char* what)
+{
+	if (table.freeSlots.empty()) {
+		throw std::runtime_error(std::string("bindless ") + what + " table is full");
+	}
+	BindlessIndex index = table.freeSlots.back();
+	table.freeSlots.pop_back();
+	return index;
+}
+
+BindlessIndex VulkanBindlessTable::AddTexture(const RHITextureRef& texture, const RHISamplerRef& sampler)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	BindlessIndex index = allocate(textures, "texture");
+	textures.resources[index] = texture;
+	textures.samplers[index] = sampler;
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.sampler = static_cast<VulkanSampler*>(sampler.get())->sampler;
+	imageInfo.imageView = static_cast<VulkanImage*>(texture.get())->view;
+	imageInfo.imageLayout = static_cast<VulkanImage*>(texture.get())->layout;
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = set;
+	write.dstBinding = BINDLESS_TEXTURE_BINDING;
+	write.dstArrayElement = index;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.descriptorCount = 1;
+	write.pImageInfo = &imageInfo;
+	write.pNext = nullptr;
+
+	vkUpdateDescriptorSets(device->Device(), 1, &write, 0, nullptr);
+	return index;
+}
+
+BindlessIndex VulkanBindlessTable::AddBuffer(const RHIBufferRef& buffer)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	BindlessIndex index = allocate(buffers, "buffer");
+	buffers.resources[index] = buffer;
+
+	VkDescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = static_cast<VulkanBuffer*>(buffer.get())->Buffer();
+	bufferInfo.offset = 0;
+	bufferInfo.range = VK_WHOLE_SIZE;
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = set;
+	write.dstBinding = BINDLESS_BUFFER_BINDING;
+	write.dstArrayElement = index;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write.descriptorCount = 1;
+	write.pBufferInfo = &bufferInfo;
+	write.pNext = nullptr;
+
+	vkUpdateDescriptorSets(device->Device(), 1, &write, 0, nullptr);
+	return index;
+}
+
+void VulkanBindlessTable::retire(Table& table, BindlessIndex index)
+{
+	if (index >= table.capacity || !table.resources[index] || table.retiring[index]) {
+		throw std::runtime_error("invalid bindless index");
+	}
+	table.retiring[index] = true;
+	table.retired.push_back({ index, currentFrame });
+}
+
+void VulkanBindlessTable::RemoveTexture(BindlessIndex index)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	retire(textures, index);
+}
+
+void VulkanBindlessTable::RemoveBuffer(BindlessIndex index)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	retire(buffers, index);
+}
+
+// The descriptor keeps pointing at the old resource, which stays alive until no frame can read it.
+void VulkanBindlessTable::recycle(Table& table)
+{
+	auto done = std::partition(table.retired.begin(), table.retired.end(),
+		[&](const Table::Retired& r) { return currentFrame - r.frame < framesInFlight; });
+
+	for (auto it = done; it != table.retired.end(); ++it) {
+		table.resources[it->index].reset();
+		if (!table.samplers.empty()) {
+			table.samplers[it->index].reset();
+		}
+		table.retiring[it->index] = false;
+		table.freeSlots.push_back(it->index);
+	}
+	table.retired.erase(done, table.retired.end());
+}
+
+void VulkanBindlessTable::BeginFrame(uint64_t frame)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	currentFrame = frame;
+	recycle(textures);
+	recycle(buffers);
+}
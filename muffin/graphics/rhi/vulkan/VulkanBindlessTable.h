@@ -0,0 +1,83 @@
+#pragma once
+
+#include "VulkanDevice.h"
+#include "muffin/graphics/rhi/RHI.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Fixed bindings of the bindless set; shaders declare them as runtime arrays in any one set, e.g.
+//   layout(set = 1, binding = 0) uniform sampler2D textures[];
+//   layout(set = 1, binding = 1) readonly buffer Data { ... } buffers[];
+const uint32_t BINDLESS_TEXTURE_BINDING = 0;
+const uint32_t BINDLESS_BUFFER_BINDING = 1;
+
+const uint32_t BINDLESS_MAX_TEXTURES = 16384;
+const uint32_t BINDLESS_MAX_BUFFERS = 4096;
+
+// One update-after-bind descriptor set holding every registered texture and storage buffer. It is
+// written in place as resources come and go, so it can stay bound for the whole frame and draws
+// select resources by index instead of by descriptor set. Released slots are only reused once the
+// frames that may still read them have completed.
+class VulkanBindlessTable
+{
+public:
+	VulkanBindlessTable(VulkanDeviceRef device, uint32_t framesInFlight);
+
+	~VulkanBindlessTable();
+
+	VkDescriptorSetLayout Layout() const;
+
+	VkDescriptorSet Set() const;
+
+	BindlessIndex AddTexture(const RHITextureRef& texture, const RHISamplerRef& sampler);
+
+	BindlessIndex AddBuffer(const RHIBufferRef& buffer);
+
+	void RemoveTexture(BindlessIndex index);
+
+	void RemoveBuffer(BindlessIndex index);
+
+	void BeginFrame(uint64_t frame);
+
+private:
+	struct Table
+	{
+		uint32_t capacity;
+		std::vector<RHIResourceRef> resources;
+		std::vector<RHIResourceRef> samplers;
+		std::vector<BindlessIndex> freeSlots;
+
+		// Set while a removed slot waits in retired, so a second remove is rejected.
+		std::vector<bool> retiring;
+
+		struct Retired
+		{
+			BindlessIndex index;
+			uint64_t frame;
+		};
+		std::vector<Retired> retired;
+	};
+
+	BindlessIndex allocate(Table& table, const char* what);
+
+	void retire(Table& table, BindlessIndex index);
+
+	void recycle(Table& table);
+
+	VulkanDeviceRef device;
+	uint32_t framesInFlight;
+
+	VkDescriptorSetLayout layout;
+	VkDescriptorPool pool;
+	VkDescriptorSet set;
+
+	std::mutex mutex;
+	uint64_t currentFrame;
+	Table textures;
+	Table buffers;
+};
+
+using VulkanBindlessTableRef = std::shared_ptr<VulkanBindlessTable>;
@@ -1,27 +1,14 @@
 #include "VulkanBuffer.h"
 #include "VulkanRHI.h"
+#include "VulkanUploadQueue.h"
 
+#include <cstring>
 #include <stdexcept>
 
-uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter,
-	VkMemoryPropertyFlags properties)
-{
-	VkPhysicalDeviceMemoryProperties memoryProperties;
-	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
-
-	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
-		if (typeFilter & (1 << i) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-			return i;
-		}
-	}
-
-	throw std::runtime_error("failed to find suitable memory type!");
-}
-
 VulkanBuffer::VulkanBuffer(VulkanDeviceRef device,
-	VkPhysicalDevice physicalDevice, uint32_t size,
+	VulkanMemoryAllocatorRef allocator, VulkanUploadQueue* uploadQueue, uint32_t size,
 	const BufferInfo& info)
-	: device(device)
+	: device(device), allocator(allocator), uploadQueue(uploadQueue)
 {
 	VkBufferCreateInfo bufferInfo;
 	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -32,12 +19,22 @@ VulkanBuffer::VulkanBuffer(VulkanDeviceRef device,
 	bufferInfo.flags = 0;
 	bufferInfo.pNext = nullptr;
 
+	VkMemoryPropertyFlags memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
 	switch (info.usage) {
 		case BufferUsage::Index:
 			bufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+			if (!info.dynamic) {
+				bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+				memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			}
 			break;
 		case BufferUsage::Vertex:
 			bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+			if (!info.dynamic) {
+				bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+				memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			}
 			break;
 		case BufferUsage::Uniform:
 			bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
@@ -45,6 +42,27 @@ VulkanBuffer::VulkanBuffer(VulkanDeviceRef device,
 		case BufferUsage::Staging:
 			bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 			break;
+		case BufferUsage::Readback:
+			bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			break;
+		case BufferUsage::Storage:
+			bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+			if (!info.dynamic) {
+				bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+				memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			}
+			break;
+		case BufferUsage::Indirect:
+			bufferInfo.usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+			if (!info.dynamic) {
+				bufferInfo.usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+				memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			}
+			break;
+	}
+
+	if (info.shaderWrite) {
+		bufferInfo.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 	}
 
 	VULKAN_RHI_SAFE_CALL(
@@ -53,23 +71,21 @@ VulkanBuffer::VulkanBuffer(VulkanDeviceRef device,
 	VkMemoryRequirements memoryRequirements;
 	vkGetBufferMemoryRequirements(device->Device(), buffer, &memoryRequirements);
 
-	VkMemoryAllocateInfo allocInfo;
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memoryRequirements.size;
-	allocInfo.memoryTypeIndex =
-		FindMemoryType(physicalDevice, memoryRequirements.memoryTypeBits,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-	allocInfo.pNext = nullptr;
+	alloc = allocator->Allocate(memoryRequirements, memoryProperties, true);
 
-	VULKAN_RHI_SAFE_CALL(
-		vkAllocateMemory(device->Device(), &allocInfo, nullptr, &alloc));
-	vkBindBufferMemory(device->Device(), buffer, alloc, 0);
+	vkBindBufferMemory(device->Device(), buffer, alloc.memory, alloc.offset);
+
+	device->Counters().buffersCreated++;
+	device->Counters().bufferBytesCreated += alloc.size;
 }
 
 VulkanBuffer::~VulkanBuffer()
 {
-	vkFreeMemory(device->Device(), alloc, nullptr);
 	vkDestroyBuffer(device->Device(), buffer, nullptr);
+	allocator->Free(alloc);
+
+	device->Counters().buffersDestroyed++;
+	device->Counters().bufferBytesFreed += alloc.size;
 }
 
 VkBuffer VulkanBuffer::Buffer() const
@@ -79,13 +95,25 @@ VkBuffer VulkanBuffer::Buffer() const
 
 VkDeviceMemory VulkanBuffer::Memory() const
 {
-	return alloc;
+	return alloc.memory;
 }
 
-void VulkanBuffer::Write(void* data, uint32_t size)
+VkDeviceSize VulkanBuffer::MemoryOffset() const
 {
-	void* devicePtr;
-	vkMapMemory(device->Device(), alloc, 0, size, 0, &devicePtr);
-	memcpy(devicePtr, data, size);
-	vkUnmapMemory(device->Device(), alloc);
+	return alloc.offset;
+}
+
+void* VulkanBuffer::Mapped()
+{
+	return alloc.mapped;
+}
+
+void VulkanBuffer::Write(const void* data, uint32_t size, uint32_t offset)
+{
+	// Device-local memory is host-visible on UMA devices, so the staging copy can be skipped there.
+	if (alloc.mapped) {
+		memcpy((uint8_t*)alloc.mapped + offset, data, size);
+	} else {
+		uploadQueue->UploadBuffer(shared_from_this(), offset, data, size);
+	}
 }
@@ -2,26 +2,35 @@
 
 #include "../RHI.h"
 #include "VulkanDevice.h"
+#include "VulkanMemoryAllocator.h"
 
 #include <memory>
 #include <vulkan/vulkan.h>
 
-class VulkanBuffer : public RHIBuffer
+class VulkanUploadQueue;
+
+class VulkanBuffer : public RHIBuffer, public std::enable_shared_from_this<VulkanBuffer>
 {
 public:
-	VulkanBuffer(VulkanDeviceRef device, VkPhysicalDevice physicalDevice,
+	VulkanBuffer(VulkanDeviceRef device, VulkanMemoryAllocatorRef allocator, VulkanUploadQueue* uploadQueue,
 		uint32_t size, const BufferInfo& info);
 
-	virtual void Write(void* data, uint32_t size) override;
+	virtual void Write(const void* data, uint32_t size, uint32_t offset = 0) override;
 
 	VkBuffer Buffer() const;
 
 	VkDeviceMemory Memory() const;
 
+	VkDeviceSize MemoryOffset() const;
+
+	void* Mapped();
+
 	virtual ~VulkanBuffer() override;
 
 private:
 	VulkanDeviceRef device;
+	VulkanMemoryAllocatorRef allocator;
+	VulkanUploadQueue* uploadQueue;
 	VkBuffer buffer;
-	VkDeviceMemory alloc;
+	VulkanAllocation alloc;
 };
\ No newline at end of file
@@ -1,24 +1,92 @@
 #include "VulkanCommandList.h"
 #include "VulkanBuffer.h"
+#include "VulkanRHI.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// Pipeline layouts are only compatible for set binding when their push constant ranges are identical.
+static bool samePushConstantRanges(const std::vector<VkPushConstantRange>& a, const std::vector<VkPushConstantRange>& b)
+{
+	return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const VkPushConstantRange& x, const VkPushConstantRange& y) {
+		return x.stageFlags == y.stageFlags && x.offset == y.offset && x.size == y.size;
+	});
+}
 
 VulkanCommandList::VulkanCommandList(VulkanDeviceRef device, VulkanCommandPoolRef commandPool, VkCommandBuffer commandBuffer, class VulkanRHI* rhi)
-	: device(device), commandPool(commandPool), commandBuffer(commandBuffer), rhi(rhi)
+	: device(device), commandPool(commandPool), commandBuffer(commandBuffer), rhi(rhi), secondary(false),
+	  inheritedRenderPass(VK_NULL_HANDLE), inheritedFramebuffer(VK_NULL_HANDLE)
 {
+	ResetState();
 }
 
 VulkanCommandList::~VulkanCommandList()
 {
-	vkFreeCommandBuffers(device->Device(), commandPool->CommandPool(), 1, &commandBuffer);
+}
+
+void VulkanCommandList::Reset()
+{
+	ownedResources.clear();
+	openRegions.clear();
+	ResetState();
+}
+
+void VulkanCommandList::ResetState()
+{
+	graphicsState = BindPointState{ .pipeline = nullptr };
+	computeState = BindPointState{ .pipeline = nullptr };
+	lastBoundPipeline = nullptr;
+	namedBindings.clear();
+	currentPipeline.reset();
+	currentComputePipeline.reset();
+
+	for (uint32_t i = 0; i < MAX_VERTEX_BINDINGS; i++) {
+		boundVertexBuffers[i] = VK_NULL_HANDLE;
+		boundVertexOffsets[i] = 0;
+	}
+	boundIndexBuffer = VK_NULL_HANDLE;
+	viewportValid = false;
+	scissorValid = false;
+}
+
+const CommandListStats& VulkanCommandList::Stats() const
+{
+	return stats;
+}
+
+void VulkanCommandList::Inherit(VkRenderPass renderPass, VkFramebuffer framebuffer)
+{
+	secondary = true;
+	inheritedRenderPass = renderPass;
+	inheritedFramebuffer = framebuffer;
 }
 
 void VulkanCommandList::Begin()
 {
+	VkCommandBufferInheritanceInfo inheritanceInfo{};
+	inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritanceInfo.renderPass = inheritedRenderPass;
+	inheritanceInfo.subpass = 0;
+	inheritanceInfo.framebuffer = inheritedFramebuffer;
+	inheritanceInfo.pNext = nullptr;
+
 	VkCommandBufferBeginInfo beginInfo{};
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	beginInfo.pInheritanceInfo = nullptr;
-	beginInfo.flags = 0;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 	beginInfo.pNext = nullptr;
+
+	if (secondary) {
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+		beginInfo.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	}
+
 	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	ResetState();
+	stats = CommandListStats{};
+	executedStats = CommandListStats{};
 }
 
 void VulkanCommandList::End()
@@ -26,7 +94,7 @@ void VulkanCommandList::End()
 	vkEndCommandBuffer(commandBuffer);
 }
 
-void VulkanCommandList::BeginRenderPass(const RHIRenderTargetRef& renderTarget)
+void VulkanCommandList::BeginRenderPass(const RHIRenderTargetRef& renderTarget, RenderPassContents contents)
 {
 	VulkanRenderTarget* vulkanRenderTarget = static_cast<VulkanRenderTarget*>(renderTarget.get());
 
@@ -47,37 +115,226 @@ void VulkanCommandList::BeginRenderPass(const RHIRenderTargetRef& renderTarget)
 	renderPassBeginInfo.pClearValues = clearValues.data();
 	renderPassBeginInfo.pNext = nullptr;
 
-	vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	// Outside the pass: subpasses executing secondary lists allow no other commands.
+	BeginRegion("Render pass");
+
+	vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo,
+		contents == RenderPassContents::Inline ? VK_SUBPASS_CONTENTS_INLINE : VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+}
+
+void VulkanCommandList::ExecuteCommandLists(const std::vector<RHICommandListRef>& commandLists)
+{
+	std::vector<VkCommandBuffer> commandBuffers;
+	commandBuffers.reserve(commandLists.size());
+
+	for (const RHICommandListRef& commandList : commandLists) {
+		VulkanCommandList* vulkanCommandList = static_cast<VulkanCommandList*>(commandList.get());
+		commandBuffers.push_back(vulkanCommandList->commandBuffer);
+		ownedResources.emplace_back(commandList);
+		executedStats += vulkanCommandList->stats;
+	}
+
+	vkCmdExecuteCommands(commandBuffer, commandBuffers.size(), commandBuffers.data());
+
+	// Secondary buffers leave the primary's bound state undefined.
+	ResetState();
 }
 
 void VulkanCommandList::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset,
 	uint32_t firstInstance)
 {
-	for (int i = 0; i < currentDescriptorSets.size(); i++) {
-		BindDescriptorSet(currentPipeline, currentDescriptorSets[i], i);
-	}
+	FlushDescriptorSets(graphicsState);
+	stats.draws++;
+	stats.instances += instanceCount;
+	stats.triangles += uint64_t(indexCount / 3) * instanceCount;
 	vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
 
-void VulkanCommandList::BindPipeline(const RHIGraphicsPipelineRef& pipeline)
+void VulkanCommandList::DrawIndexedIndirect(const RHIBufferRef& buffer, uint32_t offset, uint32_t drawCount, uint32_t stride)
+{
+	FlushDescriptorSets(graphicsState);
+	stats.indirectDraws++;
+	vkCmdDrawIndexedIndirect(commandBuffer, static_cast<VulkanBuffer*>(buffer.get())->Buffer(), offset, drawCount, stride);
+	ownedResources.emplace_back(buffer);
+}
+
+void VulkanCommandList::DrawIndexedIndirectCount(const RHIBufferRef& buffer, uint32_t offset, const RHIBufferRef& countBuffer,
+	uint32_t countOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+	if (!device->SupportsDrawIndirectCount()) {
+		throw std::runtime_error("draw indirect count is not supported by this device");
+	}
+
+	FlushDescriptorSets(graphicsState);
+	stats.indirectDraws++;
+	vkCmdDrawIndexedIndirectCount(commandBuffer, static_cast<VulkanBuffer*>(buffer.get())->Buffer(), offset,
+		static_cast<VulkanBuffer*>(countBuffer.get())->Buffer(), countOffset, maxDrawCount, stride);
+	ownedResources.emplace_back(buffer);
+	ownedResources.emplace_back(countBuffer);
+}
+
+void VulkanCommandList::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	if (!computeState.pipeline) {
+		throw std::runtime_error("Dispatch called without a bound compute pipeline");
+	}
+
+	FlushDescriptorSets(computeState);
+	stats.dispatches++;
+	vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
+void VulkanCommandList::DispatchIndirect(const RHIBufferRef& buffer, uint32_t offset)
 {
-	for (int i = 0; i < currentDescriptorSets.size(); i++) {
-		BindDescriptorSet(currentPipeline, currentDescriptorSets[i], i);
+	if (!computeState.pipeline) {
+		throw std::runtime_error("DispatchIndirect called without a bound compute pipeline");
 	}
 
-	currentDescriptorSets.clear();
+	FlushDescriptorSets(computeState);
+	stats.dispatches++;
+	vkCmdDispatchIndirect(commandBuffer, static_cast<VulkanBuffer*>(buffer.get())->Buffer(), offset);
+	ownedResources.emplace_back(buffer);
+}
 
-	VulkanGraphicsPipeline* vkPipeline = static_cast<VulkanGraphicsPipeline*>(pipeline.get());
+void VulkanCommandList::UpdateBuffer(const RHIBufferRef& buffer, uint32_t offset, const void* data, uint32_t size)
+{
+	if (size > 65536) {
+		throw std::runtime_error("UpdateBuffer is limited to 64 KiB, use a staging upload instead");
+	}
+
+	vkCmdUpdateBuffer(commandBuffer, static_cast<VulkanBuffer*>(buffer.get())->Buffer(), offset, size, data);
+	ownedResources.emplace_back(buffer);
+}
+
+void VulkanCommandList::CopyBuffer(const RHIBufferRef& src, uint32_t srcOffset, const RHIBufferRef& dst,
+	uint32_t dstOffset, uint32_t size)
+{
+	VkBufferCopy region{};
+	region.srcOffset = srcOffset;
+	region.dstOffset = dstOffset;
+	region.size = size;
+
+	vkCmdCopyBuffer(commandBuffer, static_cast<VulkanBuffer*>(src.get())->Buffer(),
+		static_cast<VulkanBuffer*>(dst.get())->Buffer(), 1, &region);
+	ownedResources.emplace_back(src);
+	ownedResources.emplace_back(dst);
+}
+
+static void barrierScope(BarrierScopeFlags scope, VkPipelineStageFlags& stages, VkAccessFlags& access)
+{
+	if (scope & BarrierTransfer) {
+		stages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+		access |= VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+	}
+	if (scope & BarrierCompute) {
+		stages |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		access |= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	}
+	if (scope & BarrierIndirect) {
+		stages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+		access |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	}
+	if (scope & BarrierVertexInput) {
+		stages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+		access |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+	}
+	if (scope & BarrierGraphicsShaders) {
+		stages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		access |= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+	}
+	if (scope & BarrierColorAttachment) {
+		stages |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		access |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	}
+}
+
+void VulkanCommandList::Barrier(BarrierScopeFlags before, BarrierScopeFlags after)
+{
+	VkPipelineStageFlags srcStages = 0, dstStages = 0;
+	VkAccessFlags srcAccess = 0, dstAccess = 0;
+	barrierScope(before, srcStages, srcAccess);
+	barrierScope(after, dstStages, dstAccess);
+
+	VkMemoryBarrier barrier{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.srcAccessMask = srcAccess,
+		.dstAccessMask = dstAccess,
+	};
+
+	vkCmdPipelineBarrier(commandBuffer, srcStages ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		dstStages ? dstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void VulkanCommandList::BindPipeline(const RHIGraphicsPipelineRef& pipeline)
+{
+	if (pipeline == currentPipeline) {
+		lastBoundPipeline = graphicsState.pipeline;
+		stats.pipelineBindsSkipped++;
+		return;
+	}
 
 	currentPipeline = pipeline;
+	bindPipeline(graphicsState, static_cast<VulkanGraphicsPipeline*>(pipeline.get()));
+}
 
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vkPipeline->PipelineHandle());
+void VulkanCommandList::BindComputePipeline(const RHIComputePipelineRef& pipeline)
+{
+	if (pipeline == currentComputePipeline) {
+		lastBoundPipeline = computeState.pipeline;
+		stats.pipelineBindsSkipped++;
+		return;
+	}
+
+	currentComputePipeline = pipeline;
+	bindPipeline(computeState, static_cast<VulkanComputePipeline*>(pipeline.get()));
+}
+
+void VulkanCommandList::bindPipeline(BindPointState& state, VulkanPipeline* pipeline)
+{
+	VulkanPipeline* previous = state.pipeline;
+	state.pipeline = pipeline;
+	lastBoundPipeline = pipeline;
+
+	vkCmdBindPipeline(commandBuffer, pipeline->BindPoint(), pipeline->PipelineHandle());
+	stats.pipelineBinds++;
+
+	// Leading sets with the same layout stay bound across the switch (pipeline layout compatibility),
+	// so e.g. the per-view set is only bound once per pass.
+	const std::vector<VkDescriptorSetLayout>& layouts = pipeline->DescriptorLayouts();
+	size_t compatible = 0;
+	if (previous && samePushConstantRanges(previous->PushConstantRanges(), pipeline->PushConstantRanges())) {
+		const std::vector<VkDescriptorSetLayout>& previousLayouts = previous->DescriptorLayouts();
+		while (compatible < layouts.size() && compatible < previousLayouts.size() &&
+			layouts[compatible] == previousLayouts[compatible]) {
+			compatible++;
+		}
+	}
+
+	state.descriptorSets.resize(compatible);
+	state.descriptorSets.resize(layouts.size(), DescriptorSetState{ .dirty = true, .boundSet = VK_NULL_HANDLE });
+
+	for (const auto& [name, bindingPoint] : pipeline->params) {
+		auto binding = namedBindings.find(name);
+		if (binding != namedBindings.end()) {
+			applyDescriptor(state, bindingPoint, binding->second);
+		}
+	}
+}
 
-	for (int i = 0; i < vkPipeline->DescriptorLayouts().size(); i++) {
-		VulkanDescriptorSetRef descriptorSet = rhi->CreateDescriptorSet(pipeline, i);
-		currentDescriptorSets.push_back(descriptorSet);
-		ownedResources.push_back(descriptorSet);
+void VulkanCommandList::PushConstants(uint32_t offset, uint32_t size, const void* data)
+{
+	VulkanPipeline* vkPipeline = lastBoundPipeline;
+	if (!vkPipeline) {
+		throw std::runtime_error("PushConstants called without a bound pipeline");
 	}
+
+	VkShaderStageFlags stages = vkPipeline->PushConstantStages(offset, size);
+	if (!stages) {
+		return;
+	}
+
+	vkCmdPushConstants(commandBuffer, vkPipeline->LayoutHandle(), stages, offset, size, data);
+	stats.pushConstants++;
 }
 
 void VulkanCommandList::SetViewport(float offsetX, float offsetY, float width, float height)
@@ -90,7 +347,17 @@ void VulkanCommandList::SetViewport(float offsetX, float offsetY, float width, f
 	viewport.minDepth = 0.0f;
 	viewport.maxDepth = 1.0f;
 
+	if (viewportValid && boundViewport.x == viewport.x && boundViewport.y == viewport.y &&
+		boundViewport.width == viewport.width && boundViewport.height == viewport.height) {
+		stats.viewportSetsSkipped++;
+		return;
+	}
+
 	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+	stats.viewportSets++;
+
+	viewportValid = true;
+	boundViewport = viewport;
 }
 
 void VulkanCommandList::SetScissors(int32_t offsetX, int32_t offsetY, uint32_t width, uint32_t height)
@@ -99,12 +366,40 @@ void VulkanCommandList::SetScissors(int32_t offsetX, int32_t offsetY, uint32_t w
 	scissor.offset = { offsetX, offsetY };
 	scissor.extent = { width, height };
 
+	if (scissorValid && boundScissor.offset.x == scissor.offset.x && boundScissor.offset.y == scissor.offset.y &&
+		boundScissor.extent.width == scissor.extent.width && boundScissor.extent.height == scissor.extent.height) {
+		stats.scissorSetsSkipped++;
+		return;
+	}
+
 	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	stats.scissorSets++;
+
+	scissorValid = true;
+	boundScissor = scissor;
 }
 
 void VulkanCommandList::EndRenderPass()
 {
 	vkCmdEndRenderPass(commandBuffer);
+	EndRegion();
+}
+
+void VulkanCommandList::BeginRegion(const char* name)
+{
+	VulkanTimestampPool* timestamps = rhi->TimestampPool();
+	openRegions.push_back(timestamps ? timestamps->BeginRegion(commandBuffer, name) : VulkanTimestampPool::NO_REGION);
+}
+
+void VulkanCommandList::EndRegion()
+{
+	if (openRegions.empty()) {
+		throw std::runtime_error("EndRegion without a matching BeginRegion");
+	}
+	if (openRegions.back() != VulkanTimestampPool::NO_REGION) {
+		rhi->TimestampPool()->EndRegion(commandBuffer, openRegions.back());
+	}
+	openRegions.pop_back();
 }
 
 void VulkanCommandList::BindVertexBuffer(const RHIBufferRef& buf, int binding)
@@ -113,48 +408,214 @@ void VulkanCommandList::BindVertexBuffer(const RHIBufferRef& buf, int binding)
 	VkBuffer buffers[] = { buffer->Buffer() };
 	VkDeviceSize offsets[] = { 0 };
 
+	if (boundVertexBuffers[binding] == buffers[0] && boundVertexOffsets[binding] == offsets[0]) {
+		stats.vertexBufferBindsSkipped++;
+		return;
+	}
+
 	vkCmdBindVertexBuffers(commandBuffer, binding, 1, buffers, offsets);
+	stats.vertexBufferBinds++;
+
+	boundVertexBuffers[binding] = buffers[0];
+	boundVertexOffsets[binding] = offsets[0];
 	ownedResources.emplace_back(buf);
 }
 
+void VulkanCommandList::BindVertexData(const void* data, uint32_t size, int binding)
+{
+	VulkanRingAllocation allocation = rhi->AllocateVertex(size);
+	memcpy(allocation.data, data, size);
+
+	VkBuffer buffers[] = { allocation.buffer->Buffer() };
+	VkDeviceSize offsets[] = { allocation.offset };
+
+	vkCmdBindVertexBuffers(commandBuffer, binding, 1, buffers, offsets);
+	stats.vertexBufferBinds++;
+
+	boundVertexBuffers[binding] = buffers[0];
+	boundVertexOffsets[binding] = offsets[0];
+}
+
+void VulkanCommandList::BindIndexData(const void* data, uint32_t size)
+{
+	VulkanRingAllocation allocation = rhi->AllocateIndex(size);
+	memcpy(allocation.data, data, size);
+
+	vkCmdBindIndexBuffer(commandBuffer, allocation.buffer->Buffer(), allocation.offset, VK_INDEX_TYPE_UINT16);
+	stats.indexBufferBinds++;
+
+	// Ring pages are never passed to BindIndexBuffer, so a later bind of any buffer is not skipped.
+	boundIndexBuffer = allocation.buffer->Buffer();
+}
+
 void VulkanCommandList::BindIndexBuffer(const RHIBufferRef& buf)
 {
 	VulkanBuffer* buffer = static_cast<VulkanBuffer*>(buf.get());
 
+	if (boundIndexBuffer == buffer->Buffer()) {
+		stats.indexBufferBindsSkipped++;
+		return;
+	}
+
 	vkCmdBindIndexBuffer(commandBuffer, buffer->Buffer(), 0, VK_INDEX_TYPE_UINT16);
+	stats.indexBufferBinds++;
 
+	boundIndexBuffer = buffer->Buffer();
 	ownedResources.emplace_back(buf);
 }
 
 void VulkanCommandList::BindUniformBuffer(const std::string& name, const RHIBufferRef& buffer, int size)
 {
-	VulkanGraphicsPipeline* vulkanPipeline = static_cast<VulkanGraphicsPipeline*>(currentPipeline.get());
-	DescriptorSetBindingPoint bindingPoint = vulkanPipeline->params[name];
-	VulkanDescriptorSetRef descriptorSet = currentDescriptorSets[bindingPoint.set];
-	descriptorSet->Update(bindingPoint.binding, buffer, size);
+	VulkanBuffer* vulkanBuffer = static_cast<VulkanBuffer*>(buffer.get());
+	SetDescriptor(name, VulkanDescriptorBinding{
+		.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+		.buffer = vulkanBuffer->Buffer(),
+		.range = (VkDeviceSize)size,
+		.dynamicOffset = 0,
+		.resource = buffer,
+	});
 }
 
-void VulkanCommandList::BindTexture(const std::string& name, const RHITextureRef& texture, const RHISamplerRef& sampler)
+void VulkanCommandList::BindUniformData(const std::string& name, const void* data, uint32_t size)
+{
+	VulkanRingAllocation allocation = rhi->AllocateUniform(size);
+	memcpy(allocation.data, data, size);
+
+	SetDescriptor(name, VulkanDescriptorBinding{
+		.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+		.buffer = allocation.buffer->Buffer(),
+		.range = size,
+		.dynamicOffset = allocation.offset,
+	});
+}
+
+void VulkanCommandList::BindStorageBuffer(const std::string& name, const RHIBufferRef& buffer)
+{
+	VulkanBuffer* vulkanBuffer = static_cast<VulkanBuffer*>(buffer.get());
+	SetDescriptor(name, VulkanDescriptorBinding{
+		.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+		.buffer = vulkanBuffer->Buffer(),
+		.range = VK_WHOLE_SIZE,
+		.dynamicOffset = 0,
+		.resource = buffer,
+	});
+}
+
+void VulkanCommandList::BindStorageData(const std::string& name, const void* data, uint32_t size)
 {
-	VulkanGraphicsPipeline* vulkanPipeline = static_cast<VulkanGraphicsPipeline*>(currentPipeline.get());
-	DescriptorSetBindingPoint bindingPoint = vulkanPipeline->params[name];
-	VulkanDescriptorSetRef descriptorSet = currentDescriptorSets[bindingPoint.set];
+	VulkanRingAllocation allocation = rhi->AllocateStorage(size);
+	memcpy(allocation.data, data, size);
+
+	SetDescriptor(name, VulkanDescriptorBinding{
+		.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+		.buffer = allocation.buffer->Buffer(),
+		.range = size,
+		.dynamicOffset = allocation.offset,
+	});
+}
+
+void VulkanCommandList::BindStorageImage(const std::string& name, const RHITextureRef& texture)
+{
+	VulkanImage* vulkanImage = static_cast<VulkanImage*>(texture.get());
+	if (vulkanImage->layout != VK_IMAGE_LAYOUT_GENERAL) {
+		throw std::runtime_error("BindStorageImage needs a texture from CreateStorageTexture");
+	}
 
+	SetDescriptor(name, VulkanDescriptorBinding{
+		.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+		.view = vulkanImage->view,
+		.imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+		.resource = texture,
+	});
+}
+
+void VulkanCommandList::BindTexture(const std::string& name, const RHITextureRef& texture, const RHISamplerRef& sampler)
+{
 	VulkanImage* vulkanImage = static_cast<VulkanImage*>(texture.get());
 	VulkanSampler* vulkanSampler = static_cast<VulkanSampler*>(sampler.get());
-	descriptorSet->Update(bindingPoint.binding, *vulkanImage, *vulkanSampler);
+	SetDescriptor(name, VulkanDescriptorBinding{
+		.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.view = vulkanImage->view,
+		.sampler = vulkanSampler->sampler,
+		.imageLayout = vulkanImage->layout,
+		.resource = texture,
+		.samplerResource = sampler,
+	});
 }
 
-void VulkanCommandList::BindDescriptorSet(const RHIGraphicsPipelineRef& pipeline,
-	const VulkanDescriptorSetRef& descriptorSet, int binding)
+void VulkanCommandList::SetDescriptor(const std::string& name, VulkanDescriptorBinding descriptor)
 {
-	VulkanGraphicsPipeline* vulkanPipeline = static_cast<VulkanGraphicsPipeline*>(pipeline.get());
+	namedBindings[name] = descriptor;
+
+	for (BindPointState* state : { &graphicsState, &computeState }) {
+		if (!state->pipeline) {
+			continue;
+		}
+		// find() rather than operator[]: the pipeline is shared by lists recorded on other threads.
+		auto param = state->pipeline->params.find(name);
+		if (param != state->pipeline->params.end()) {
+			applyDescriptor(*state, param->second, descriptor);
+		}
+	}
+}
 
-	VulkanDescriptorSet* set = static_cast<VulkanDescriptorSet*>(descriptorSet.get());
+void VulkanCommandList::applyDescriptor(BindPointState& bindPoint, DescriptorSetBindingPoint bindingPoint,
+	VulkanDescriptorBinding descriptor)
+{
+	DescriptorSetState& state = bindPoint.descriptorSets[bindingPoint.set];
 
-	VkDescriptorSet descriptorSets[] = { set->DescriptorSetHandle() };
+	descriptor.binding = bindingPoint.binding;
 
-	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkanPipeline->LayoutHandle(), binding, 1, descriptorSets, 0, nullptr);
+	auto it = state.bindings.begin();
+	while (it != state.bindings.end() && it->binding < descriptor.binding) {
+		++it;
+	}
+	if (it != state.bindings.end() && it->binding == descriptor.binding) {
+		if (it->SameDescriptor(descriptor) && it->dynamicOffset == descriptor.dynamicOffset) {
+			return;
+		}
+		*it = std::move(descriptor);
+	} else {
+		state.bindings.insert(it, std::move(descriptor));
+	}
+	state.dirty = true;
+}
 
-	ownedResources.emplace_back(descriptorSet);
+void VulkanCommandList::FlushDescriptorSets(BindPointState& bindPoint)
+{
+	VulkanPipeline* vulkanPipeline = bindPoint.pipeline;
+	VulkanDescriptorCache& cache = rhi->DescriptorCache();
+
+	for (uint32_t i = 0; i < bindPoint.descriptorSets.size(); i++) {
+		DescriptorSetState& state = bindPoint.descriptorSets[i];
+		if (!state.dirty) {
+			continue;
+		}
+
+		// The bindless table is a single set that is updated in place, so it only needs binding once.
+		VkDescriptorSet descriptorSet = (int)i == vulkanPipeline->BindlessSet()
+			? rhi->BindlessTable()->Set()
+			: cache.Get(vulkanPipeline->DescriptorLayouts()[i], state.bindings);
+
+		std::vector<uint32_t> dynamicOffsets;
+		for (const VulkanDescriptorBinding& b : state.bindings) {
+			if (b.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || b.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) {
+				dynamicOffsets.push_back(b.dynamicOffset);
+			}
+		}
+
+		state.dirty = false;
+
+		if (descriptorSet == state.boundSet && dynamicOffsets == state.boundDynamicOffsets) {
+			stats.descriptorSetBindsSkipped++;
+			continue;
+		}
+
+		vkCmdBindDescriptorSets(commandBuffer, vulkanPipeline->BindPoint(), vulkanPipeline->LayoutHandle(), i, 1,
+			&descriptorSet, dynamicOffsets.size(), dynamicOffsets.data());
+		stats.descriptorSetBinds++;
+
+		state.boundSet = descriptorSet;
+		state.boundDynamicOffsets = std::move(dynamicOffsets);
+	}
 }
\ No newline at end of file
@@ -1,45 +1,120 @@
 #pragma once
 
 #include "VulkanCommandPool.h"
-#include "VulkanDescriptorSet.h"
+#include "VulkanDescriptorCache.h"
 #include "VulkanDevice.h"
+#include "VulkanComputePipeline.h"
 #include "VulkanGraphicsPipeline.h"
+#include "VulkanTimestampPool.h"
 
+#include <unordered_map>
 #include <vulkan/vulkan.h>
 
+const uint32_t MAX_VERTEX_BINDINGS = 16;
+
 struct VulkanCommandList : public RHICommandList
 {
 	explicit VulkanCommandList(VulkanDeviceRef device, VulkanCommandPoolRef commandPool, VkCommandBuffer commandBuffer, class VulkanRHI* rhi);
 
 	virtual ~VulkanCommandList() override;
 
+	void Reset();
+
 	virtual void Begin() override;
 
 	virtual void End() override;
 
 	virtual void BindPipeline(const RHIGraphicsPipelineRef& pipeline) override;
 
-	virtual void BeginRenderPass(const RHIRenderTargetRef& renderTarget) override;
+	virtual void BindComputePipeline(const RHIComputePipelineRef& pipeline) override;
+
+	virtual void BeginRenderPass(const RHIRenderTargetRef& renderTarget, RenderPassContents contents) override;
+
+	virtual void PushConstants(uint32_t offset, uint32_t size, const void* data) override;
 
 	virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset,
 		uint32_t firstInstance) override;
 
+	virtual void DrawIndexedIndirect(const RHIBufferRef& buffer, uint32_t offset, uint32_t drawCount, uint32_t stride) override;
+
+	virtual void DrawIndexedIndirectCount(const RHIBufferRef& buffer, uint32_t offset, const RHIBufferRef& countBuffer,
+		uint32_t countOffset, uint32_t maxDrawCount, uint32_t stride) override;
+
+	virtual void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override;
+
+	virtual void DispatchIndirect(const RHIBufferRef& buffer, uint32_t offset) override;
+
+	virtual void UpdateBuffer(const RHIBufferRef& buffer, uint32_t offset, const void* data, uint32_t size) override;
+
+	virtual void CopyBuffer(const RHIBufferRef& src, uint32_t srcOffset, const RHIBufferRef& dst, uint32_t dstOffset,
+		uint32_t size) override;
+
+	virtual void Barrier(BarrierScopeFlags before, BarrierScopeFlags after) override;
+
 	virtual void SetViewport(float offsetX, float offsetY, float width, float height) override;
 
 	virtual void SetScissors(int32_t offsetX, int32_t offsetY, uint32_t width, uint32_t height) override;
 
 	virtual void EndRenderPass() override;
 
+	virtual void BeginRegion(const char* name) override;
+
+	virtual void EndRegion() override;
+
 	virtual void BindVertexBuffer(const RHIBufferRef& buf, int binding) override;
 
 	virtual void BindIndexBuffer(const RHIBufferRef& buf) override;
 
+	virtual void BindVertexData(const void* data, uint32_t size, int binding) override;
+
+	virtual void BindIndexData(const void* data, uint32_t size) override;
+
 	virtual void BindUniformBuffer(const std::string& name, const RHIBufferRef& buffer, int size) override;
 
+	virtual void BindUniformData(const std::string& name, const void* data, uint32_t size) override;
+
+	virtual void BindStorageBuffer(const std::string& name, const RHIBufferRef& buffer) override;
+
+	virtual void BindStorageData(const std::string& name, const void* data, uint32_t size) override;
+
+	virtual void BindStorageImage(const std::string& name, const RHITextureRef& texture) override;
+
 	virtual void BindTexture(const std::string& name, const RHITextureRef& texture, const RHISamplerRef& sampler);
 
-	void BindDescriptorSet(const RHIGraphicsPipelineRef& pipeline,
-		const VulkanDescriptorSetRef& descriptorSet, int binding);
+	virtual void ExecuteCommandLists(const std::vector<RHICommandListRef>& commandLists) override;
+
+	virtual const CommandListStats& Stats() const override;
+
+	// Turns this into a secondary list continuing renderPass; applied by the next Begin().
+	void Inherit(VkRenderPass renderPass, VkFramebuffer framebuffer);
+
+	// Bindings are remembered by name until the list is reset and re-applied to every pipeline bound
+	// afterwards that declares the same name.
+	void SetDescriptor(const std::string& name, VulkanDescriptorBinding descriptor);
+
+	struct DescriptorSetState
+	{
+		std::vector<VulkanDescriptorBinding> bindings;
+		bool dirty;
+
+		VkDescriptorSet boundSet;
+		std::vector<uint32_t> boundDynamicOffsets;
+	};
+
+	// Graphics and compute pipelines are bound independently, each with its own descriptor sets.
+	struct BindPointState
+	{
+		VulkanPipeline* pipeline;
+		std::vector<DescriptorSetState> descriptorSets;
+	};
+
+	void FlushDescriptorSets(BindPointState& bindPoint);
+
+	void ResetState();
+
+	void bindPipeline(BindPointState& state, VulkanPipeline* pipeline);
+
+	void applyDescriptor(BindPointState& bindPoint, DescriptorSetBindingPoint bindingPoint, VulkanDescriptorBinding descriptor);
 
 	class VulkanRHI* rhi;
 
@@ -47,11 +122,36 @@ struct VulkanCommandList : public RHICommandList
 	VulkanCommandPoolRef commandPool;
 	VkCommandBuffer commandBuffer;
 
+	bool secondary;
+	VkRenderPass inheritedRenderPass;
+	VkFramebuffer inheritedFramebuffer;
+
 	std::vector<RHIResourceRef> ownedResources;
 
-	std::vector<VulkanDescriptorSetRef> currentDescriptorSets;
+	BindPointState graphicsState;
+	BindPointState computeState;
+	std::unordered_map<std::string, VulkanDescriptorBinding> namedBindings;
 
 	RHIGraphicsPipelineRef currentPipeline;
+	RHIComputePipelineRef currentComputePipeline;
+	// Whichever pipeline was bound last, which PushConstants applies to.
+	VulkanPipeline* lastBoundPipeline;
+
+	// State already recorded into commandBuffer, used to drop binds that would not change anything.
+	VkBuffer boundVertexBuffers[MAX_VERTEX_BINDINGS];
+	VkDeviceSize boundVertexOffsets[MAX_VERTEX_BINDINGS];
+	VkBuffer boundIndexBuffer;
+	bool viewportValid;
+	VkViewport boundViewport;
+	bool scissorValid;
+	VkRect2D boundScissor;
+
+	// Timestamp regions begun but not yet ended, innermost last; NO_REGION when not timed.
+	std::vector<uint32_t> openRegions;
+
+	CommandListStats stats;
+	// Sum of the secondary lists executed by this one, which the driver adds up at submit.
+	CommandListStats executedStats;
 };
 
 using VulkanCommandListRef = std::shared_ptr<VulkanCommandList>;
\ No newline at end of file
@@ -0,0 +1,26 @@
+#include "VulkanComputePipeline.h"
+#include "Shared.h"
+
+VulkanComputePipeline::VulkanComputePipeline(VulkanDeviceRef device, VulkanDescriptorLayoutCacheRef layoutCache,
+	VulkanBindlessTableRef bindlessTable, VkPipelineCache pipelineCache, const ComputePipelineCreateInfo& info)
+	: VulkanPipeline(device, layoutCache, bindlessTable, VK_PIPELINE_BIND_POINT_COMPUTE)
+{
+	VulkanShader* computeShader = static_cast<VulkanShader*>(info.computeShader.get());
+	shaders.push_back(info.computeShader);
+
+	createLayout({ computeShader });
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = computeShader->module;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.layout = layoutHandle;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineInfo.basePipelineIndex = -1;
+	pipelineInfo.flags = 0;
+	pipelineInfo.pNext = nullptr;
+
+	VULKAN_RHI_SAFE_CALL(vkCreateComputePipelines(device->Device(), pipelineCache, 1, &pipelineInfo, nullptr, &pipelineHandle));
+}
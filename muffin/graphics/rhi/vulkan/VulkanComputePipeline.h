@@ -0,0 +1,11 @@
+#pragma once
+
+#include "VulkanPipeline.h"
+#include "muffin/graphics/rhi/RHI.h"
+
+class VulkanComputePipeline : public RHIComputePipeline, public VulkanPipeline
+{
+public:
+	VulkanComputePipeline(VulkanDeviceRef device, VulkanDescriptorLayoutCacheRef layoutCache,
+		VulkanBindlessTableRef bindlessTable, VkPipelineCache pipelineCache, const ComputePipelineCreateInfo& info);
+};
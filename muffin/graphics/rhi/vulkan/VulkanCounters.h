@@ -0,0 +1,54 @@
+#pragma once
+
+#include "muffin/graphics/rhi/RHI.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Running totals of a device's allocations, submits and waits, bumped next to the Vulkan calls they count.
+// Atomic, as resources are created and freed from any thread; none of the counted calls is frequent enough for
+// that to matter.
+struct VulkanCounters
+{
+	std::atomic<uint64_t> submits{ 0 };
+	std::atomic<uint64_t> fenceWaits{ 0 };
+	std::atomic<uint64_t> fenceWaitNs{ 0 };
+	std::atomic<uint64_t> descriptorSetsAllocated{ 0 };
+	std::atomic<uint64_t> memoryAllocations{ 0 };
+	std::atomic<uint64_t> memoryFrees{ 0 };
+	std::atomic<uint64_t> buffersCreated{ 0 };
+	std::atomic<uint64_t> buffersDestroyed{ 0 };
+	std::atomic<uint64_t> bufferBytesCreated{ 0 };
+	std::atomic<uint64_t> bufferBytesFreed{ 0 };
+	std::atomic<uint64_t> texturesCreated{ 0 };
+	std::atomic<uint64_t> texturesDestroyed{ 0 };
+	std::atomic<uint64_t> textureBytesCreated{ 0 };
+	std::atomic<uint64_t> textureBytesFreed{ 0 };
+
+	// Counts a wait that started at begin and has just returned.
+	void AddWait(std::chrono::steady_clock::time_point begin)
+	{
+		fenceWaits++;
+		fenceWaitNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	// Copies the totals into the matching RHIStats fields; the command counters are left alone.
+	void Read(RHIStats& stats) const
+	{
+		stats.submits = submits.load(std::memory_order_relaxed);
+		stats.fenceWaits = fenceWaits.load(std::memory_order_relaxed);
+		stats.fenceWaitNs = fenceWaitNs.load(std::memory_order_relaxed);
+		stats.descriptorSetsAllocated = descriptorSetsAllocated.load(std::memory_order_relaxed);
+		stats.memoryAllocations = memoryAllocations.load(std::memory_order_relaxed);
+		stats.memoryFrees = memoryFrees.load(std::memory_order_relaxed);
+		stats.buffersCreated = buffersCreated.load(std::memory_order_relaxed);
+		stats.buffersDestroyed = buffersDestroyed.load(std::memory_order_relaxed);
+		stats.bufferBytesCreated = bufferBytesCreated.load(std::memory_order_relaxed);
+		stats.bufferBytesFreed = bufferBytesFreed.load(std::memory_order_relaxed);
+		stats.texturesCreated = texturesCreated.load(std::memory_order_relaxed);
+		stats.texturesDestroyed = texturesDestroyed.load(std::memory_order_relaxed);
+		stats.textureBytesCreated = textureBytesCreated.load(std::memory_order_relaxed);
+		stats.textureBytesFreed = textureBytesFreed.load(std::memory_order_relaxed);
+	}
+};
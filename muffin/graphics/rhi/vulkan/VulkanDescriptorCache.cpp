@@ -0,0 +1,210 @@
+#include "VulkanDescriptorCache.h"
+#include "Shared.h"
+
+#include <functional>
+#include <stdexcept>
+
+bool VulkanDescriptorBinding::SameDescriptor(const VulkanDescriptorBinding& other) const
+{
+	return binding == other.binding && type == other.type && buffer == other.buffer && range == other.range &&
+		view == other.view && sampler == other.sampler;
+}
+
+static void hashCombine(size_t& seed, size_t value)
+{
+	seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+static size_t hashBindings(VkDescriptorSetLayout layout, const std::vector<VulkanDescriptorBinding>& bindings)
+{
+	size_t seed = std::hash<const void*>()(layout);
+	for (const VulkanDescriptorBinding& b : bindings) {
+		hashCombine(seed, b.binding);
+		hashCombine(seed, b.type);
+		hashCombine(seed, std::hash<const void*>()(b.buffer));
+		hashCombine(seed, b.range);
+		hashCombine(seed, std::hash<const void*>()(b.view));
+		hashCombine(seed, std::hash<const void*>()(b.sampler));
+	}
+	return seed;
+}
+
+static bool sameBindings(const std::vector<VulkanDescriptorBinding>& lhs, const std::vector<VulkanDescriptorBinding>& rhs)
+{
+	if (lhs.size() != rhs.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < lhs.size(); i++) {
+		if (!lhs[i].SameDescriptor(rhs[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t VulkanDescriptorCache::KeyHash::operator()(const Key& key) const
+{
+	return hashBindings(key.layout, key.bindings);
+}
+
+size_t VulkanDescriptorCache::KeyHash::operator()(const KeyView& key) const
+{
+	return hashBindings(key.layout, key.bindings);
+}
+
+bool VulkanDescriptorCache::KeyEqual::operator()(const Key& lhs, const Key& rhs) const
+{
+	return lhs.layout == rhs.layout && sameBindings(lhs.bindings, rhs.bindings);
+}
+
+bool VulkanDescriptorCache::KeyEqual::operator()(const KeyView& lhs, const Key& rhs) const
+{
+	return lhs.layout == rhs.layout && sameBindings(lhs.bindings, rhs.bindings);
+}
+
+bool VulkanDescriptorCache::KeyEqual::operator()(const Key& lhs, const KeyView& rhs) const
+{
+	return lhs.layout == rhs.layout && sameBindings(lhs.bindings, rhs.bindings);
+}
+
+VulkanDescriptorCache::VulkanDescriptorCache(VulkanDeviceRef device)
+	: device(device), currentPool(0), deadSets(0), currentFrame(0)
+{
+	pools.push_back(createPool());
+}
+
+VulkanDescriptorPoolRef VulkanDescriptorCache::createPool()
+{
+	// Only the descriptor types shader reflection produces; uniform buffers are always bound dynamic.
+	VkDescriptorPoolSize poolSizes[4];
+	poolSizes[0].descriptorCount = DESCRIPTOR_POOL_MAX_SETS * 4;
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+	poolSizes[1].descriptorCount = DESCRIPTOR_POOL_MAX_SETS * 4;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+
+	poolSizes[2].descriptorCount = DESCRIPTOR_POOL_MAX_SETS * 4;
+	poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+
+	poolSizes[3].descriptorCount = DESCRIPTOR_POOL_MAX_SETS * 4;
+	poolSizes[3].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+
+	VkDescriptorPoolCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	createInfo.poolSizeCount = 4;
+	createInfo.pPoolSizes = poolSizes;
+	createInfo.maxSets = DESCRIPTOR_POOL_MAX_SETS;
+	createInfo.flags = 0;
+	createInfo.pNext = nullptr;
+
+	VkDescriptorPool descriptorPool;
+
+	VULKAN_RHI_SAFE_CALL(vkCreateDescriptorPool(device->Device(), &createInfo, nullptr, &descriptorPool));
+
+	return VulkanDescriptorPoolRef(new VulkanDescriptorPool(device, descriptorPool));
+}
+
+VkDescriptorSet VulkanDescriptorCache::allocate(VkDescriptorSetLayout layout)
+{
+	VkDescriptorSetAllocateInfo allocInfo;
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &layout;
+	allocInfo.pNext = nullptr;
+
+	VkDescriptorSet set;
+	bool newPool = false;
+	while (true) {
+		allocInfo.descriptorPool = pools[currentPool]->Handle();
+
+		VkResult result = vkAllocateDescriptorSets(device->Device(), &allocInfo, &set);
+		if (result == VK_SUCCESS) {
+			device->Counters().descriptorSetsAllocated++;
+			return set;
+		}
+		if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+			throw std::runtime_error("failed to allocate descriptor set!");
+		}
+		// A layout that does not fit in an empty pool never will; more pools would only leak.
+		if (newPool) {
+			throw std::runtime_error("descriptor set layout does not fit in a descriptor pool");
+		}
+
+		currentPool++;
+		if (currentPool == pools.size()) {
+			pools.push_back(createPool());
+			newPool = true;
+		}
+	}
+}
+
+VkDescriptorSet VulkanDescriptorCache::Get(VkDescriptorSetLayout layout, const std::vector<VulkanDescriptorBinding>& bindings)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto it = sets.find(KeyView{ layout, bindings });
+	if (it != sets.end()) {
+		it->second.lastUsed = currentFrame;
+		return it->second.set;
+	}
+
+	VkDescriptorSet set = allocate(layout);
+
+	std::vector<VkDescriptorBufferInfo> bufferInfos;
+	std::vector<VkDescriptorImageInfo> imageInfos;
+	std::vector<VkWriteDescriptorSet> writes;
+	bufferInfos.reserve(bindings.size());
+	imageInfos.reserve(bindings.size());
+	writes.reserve(bindings.size());
+
+	for (const VulkanDescriptorBinding& b : bindings) {
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = set;
+		write.dstBinding = b.binding;
+		write.dstArrayElement = 0;
+		write.descriptorType = b.type;
+		write.descriptorCount = 1;
+		write.pNext = nullptr;
+
+		if (b.type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || b.type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE) {
+			imageInfos.push_back(VkDescriptorImageInfo{ .sampler = b.sampler, .imageView = b.view, .imageLayout = b.imageLayout });
+			write.pImageInfo = &imageInfos.back();
+		} else {
+			bufferInfos.push_back(VkDescriptorBufferInfo{ .buffer = b.buffer, .offset = 0, .range = b.range });
+			write.pBufferInfo = &bufferInfos.back();
+		}
+		writes.push_back(write);
+	}
+
+	vkUpdateDescriptorSets(device->Device(), writes.size(), writes.data(), 0, nullptr);
+
+	sets.emplace(Key{ layout, bindings }, Entry{ .set = set, .lastUsed = currentFrame });
+	return set;
+}
+
+void VulkanDescriptorCache::BeginFrame(uint64_t frame)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	currentFrame = frame;
+
+	for (auto it = sets.begin(); it != sets.end();) {
+		if (frame - it->second.lastUsed > DESCRIPTOR_CACHE_MAX_AGE) {
+			it = sets.erase(it);
+			deadSets++;
+		} else {
+			++it;
+		}
+	}
+
+	// Sets cannot be freed one by one, so stale ones are reclaimed together once they outnumber live ones.
+	if (deadSets > DESCRIPTOR_POOL_MAX_SETS && deadSets > sets.size()) {
+		for (auto& pool : pools) {
+			vkResetDescriptorPool(device->Device(), pool->Handle(), 0);
+		}
+		sets.clear();
+		currentPool = 0;
+		deadSets = 0;
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../RHI.h"
+#include "VulkanDescriptorPool.h"
+#include "VulkanDevice.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+const uint32_t DESCRIPTOR_POOL_MAX_SETS = 256;
+const uint64_t DESCRIPTOR_CACHE_MAX_AGE = 16;
+
+struct VulkanDescriptorBinding
+{
+	uint32_t binding;
+	VkDescriptorType type;
+	VkBuffer buffer;
+	VkDeviceSize range;
+	VkImageView view;
+	VkSampler sampler;
+	// Follows from view, so it is not compared either.
+	VkImageLayout imageLayout;
+
+	// Not part of the cache key: dynamic offsets are supplied at bind time, and the references
+	// only keep the bound resources alive while a cached set still points at them.
+	uint32_t dynamicOffset;
+	RHIResourceRef resource;
+	RHIResourceRef samplerResource;
+
+	bool SameDescriptor(const VulkanDescriptorBinding& other) const;
+};
+
+// Descriptor sets written for a frame slot, keyed by layout and bound resources. Sets are reused
+// whenever the same combination is bound again and are only reclaimed all at once, by resetting
+// the slot's pools once enough cached sets have gone unused. Get() may be called from any thread.
+class VulkanDescriptorCache
+{
+public:
+	explicit VulkanDescriptorCache(VulkanDeviceRef device);
+
+	VkDescriptorSet Get(VkDescriptorSetLayout layout, const std::vector<VulkanDescriptorBinding>& bindings);
+
+	void BeginFrame(uint64_t frame);
+
+private:
+	struct Key
+	{
+		VkDescriptorSetLayout layout;
+		std::vector<VulkanDescriptorBinding> bindings;
+	};
+
+	struct KeyView
+	{
+		VkDescriptorSetLayout layout;
+		const std::vector<VulkanDescriptorBinding>& bindings;
+	};
+
+	struct KeyHash
+	{
+		using is_transparent = void;
+
+		size_t operator()(const Key& key) const;
+
+		size_t operator()(const KeyView& key) const;
+	};
+
+	struct KeyEqual
+	{
+		using is_transparent = void;
+
+		bool operator()(const Key& lhs, const Key& rhs) const;
+
+		bool operator()(const KeyView& lhs, const Key& rhs) const;
+
+		bool operator()(const Key& lhs, const KeyView& rhs) const;
+	};
+
+	struct Entry
+	{
+		VkDescriptorSet set;
+		uint64_t lastUsed;
+	};
+
+	VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+	VulkanDescriptorPoolRef createPool();
+
+	VulkanDeviceRef device;
+
+	std::mutex mutex;
+
+	std::vector<VulkanDescriptorPoolRef> pools;
+	size_t currentPool;
+
+	std::unordered_map<Key, Entry, KeyHash, KeyEqual> sets;
+	size_t deadSets;
+
+	uint64_t currentFrame;
+};
+
+using VulkanDescriptorCacheRef = std::shared_ptr<VulkanDescriptorCache>;
@@ -0,0 +1,56 @@
+#include "VulkanDescriptorLayoutCache.h"
+#include "Shared.h"
+
+#include <algorithm>
+
+VulkanDescriptorLayoutCache::VulkanDescriptorLayoutCache(VulkanDeviceRef device)
+	: device(device)
+{
+}
+
+VulkanDescriptorLayoutCache::~VulkanDescriptorLayoutCache()
+{
+	for (auto& [key, layout] : layouts) {
+		vkDestroyDescriptorSetLayout(device->Device(), layout, nullptr);
+	}
+}
+
+VkDescriptorSetLayout VulkanDescriptorLayoutCache::Get(std::vector<VkDescriptorSetLayoutBinding> bindings)
+{
+	std::sort(bindings.begin(), bindings.end(),
+		[](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) { return a.binding < b.binding; });
+
+	std::vector<VkDescriptorSetLayoutBinding> merged;
+	for (const VkDescriptorSetLayoutBinding& b : bindings) {
+		if (!merged.empty() && merged.back().binding == b.binding) {
+			merged.back().stageFlags |= b.stageFlags;
+		} else {
+			merged.push_back(b);
+		}
+	}
+
+	std::vector<uint32_t> key;
+	for (const VkDescriptorSetLayoutBinding& b : merged) {
+		key.insert(key.end(), { b.binding, (uint32_t)b.descriptorType, b.descriptorCount, b.stageFlags });
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto it = layouts.find(key);
+	if (it != layouts.end()) {
+		return it->second;
+	}
+
+	VkDescriptorSetLayoutCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	createInfo.bindingCount = merged.size();
+	createInfo.pBindings = merged.data();
+	createInfo.flags = 0;
+	createInfo.pNext = nullptr;
+
+	VkDescriptorSetLayout layout;
+	VULKAN_RHI_SAFE_CALL(vkCreateDescriptorSetLayout(device->Device(), &createInfo, nullptr, &layout));
+
+	layouts.emplace(std::move(key), layout);
+	return layout;
+}
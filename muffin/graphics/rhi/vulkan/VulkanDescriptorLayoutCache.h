@@ -0,0 +1,31 @@
+#pragma once
+
+#include "VulkanDevice.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Deduplicates descriptor set layouts by their bindings. Pipelines whose sets have the same bindings
+// get the very same layout handle, which lets a set bound for one pipeline stay bound across a
+// switch to another and lets cached descriptor sets be shared between them.
+class VulkanDescriptorLayoutCache
+{
+public:
+	explicit VulkanDescriptorLayoutCache(VulkanDeviceRef device);
+
+	~VulkanDescriptorLayoutCache();
+
+	// Bindings declared by several stages are merged into one with the union of their stage flags.
+	VkDescriptorSetLayout Get(std::vector<VkDescriptorSetLayoutBinding> bindings);
+
+private:
+	VulkanDeviceRef device;
+
+	std::mutex mutex;
+	std::map<std::vector<uint32_t>, VkDescriptorSetLayout> layouts;
+};
+
+using VulkanDescriptorLayoutCacheRef = std::shared_ptr<VulkanDescriptorLayoutCache>;
@@ -1,4 +1,27 @@
 #include "VulkanDevice.h"
+#include "Shared.h"
+
+#include <stdexcept>
+
+// Vulkan 1.2 with timeline semaphores, which the upload queue synchronizes with.
+bool meetsRequirements(VkPhysicalDevice physicalDevice)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	if (properties.apiVersion < VK_API_VERSION_1_2) {
+		return false;
+	}
+
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	VkPhysicalDeviceFeatures2 features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &vulkan12Features;
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+	return vulkan12Features.timelineSemaphore;
+}
 
 VkPhysicalDevice choosePhysicalDevice(VkInstance instance)
 {
@@ -8,6 +31,15 @@ VkPhysicalDevice choosePhysicalDevice(VkInstance instance)
 	std::vector<VkPhysicalDevice> physicalDevices(deviceCount);
 
 	vkEnumeratePhysicalDevices(instance, &deviceCount, physicalDevices.data());
+	if (physicalDevices.empty()) {
+		throw std::runtime_error("no Vulkan device found");
+	}
+
+	std::erase_if(physicalDevices, [](VkPhysicalDevice device) { return !meetsRequirements(device); });
+	if (physicalDevices.empty()) {
+		throw std::runtime_error("no Vulkan 1.2 device with timeline semaphores found");
+	}
+
 	for (auto& device : physicalDevices) {
 		VkPhysicalDeviceProperties deviceProperties;
 		vkGetPhysicalDeviceProperties(device, &deviceProperties);
@@ -15,8 +47,54 @@ VkPhysicalDevice choosePhysicalDevice(VkInstance instance)
 			return device;
 		}
 	}
-	// TODO: throw
-	return nullptr;
+	// Integrated GPUs and software rasterizers such as lavapipe.
+	return physicalDevices[0];
+}
+
+// Descriptor indexing features needed by VulkanBindlessTable, core since Vulkan 1.2.
+bool supportsBindless(VkPhysicalDevice physicalDevice)
+{
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	VkPhysicalDeviceFeatures2 features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &vulkan12Features;
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+	return vulkan12Features.runtimeDescriptorArray && vulkan12Features.descriptorBindingPartiallyBound &&
+		vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+		vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+		vulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+		vulkan12Features.shaderSampledImageArrayNonUniformIndexing &&
+		vulkan12Features.shaderStorageBufferArrayNonUniformIndexing;
+}
+
+bool supportsDrawIndirectCount(VkPhysicalDevice physicalDevice)
+{
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	VkPhysicalDeviceFeatures2 features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &vulkan12Features;
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+	return vulkan12Features.drawIndirectCount && features.features.multiDrawIndirect;
+}
+
+// GPU timestamps need a queue that can write them and host-side query resets, core since Vulkan 1.2.
+bool supportsTimestamps(VkPhysicalDevice physicalDevice, const VkQueueFamilyProperties& graphicsFamily)
+{
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	VkPhysicalDeviceFeatures2 features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &vulkan12Features;
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+	return vulkan12Features.hostQueryReset && graphicsFamily.timestampValidBits > 0;
 }
 
 std::vector<VkQueueFamilyProperties>
@@ -62,7 +140,8 @@ uint32_t findPresentFamilyIdx(VkPhysicalDevice device, VkSurfaceKHR surface)
 
 VkDevice createDevice(VkPhysicalDevice physicalDevice,
 	uint32_t graphicsFamilyIdx, uint32_t presentFamilyIdx,
-	const std::vector<const char*>& deviceExtensions)
+	const std::vector<const char*>& deviceExtensions, const VkPhysicalDeviceFeatures& supportedFeatures, bool bindless,
+	bool drawIndirectCount, bool timestamps)
 {
 	float queuePriority = 1.0f;
 
@@ -88,6 +167,25 @@ VkDevice createDevice(VkPhysicalDevice physicalDevice,
 
 	VkPhysicalDeviceFeatures deviceFeatures{};
 	deviceFeatures.samplerAnisotropy = true;
+	// Indirect draws that start at a non-zero instance, as GPU culling writes them.
+	deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+	deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	vulkan12Features.timelineSemaphore = true;
+	vulkan12Features.drawIndirectCount = drawIndirectCount;
+	vulkan12Features.hostQueryReset = timestamps;
+	if (bindless) {
+		vulkan12Features.runtimeDescriptorArray = true;
+		vulkan12Features.descriptorBindingPartiallyBound = true;
+		vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = true;
+		vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = true;
+		vulkan12Features.descriptorBindingUpdateUnusedWhilePending = true;
+		vulkan12Features.shaderSampledImageArrayNonUniformIndexing = true;
+		vulkan12Features.shaderStorageBufferArrayNonUniformIndexing = true;
+	}
+	vulkan12Features.pNext = nullptr;
 
 	VkDeviceCreateInfo deviceCreateInfo{};
 	deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -97,10 +195,10 @@ VkDevice createDevice(VkPhysicalDevice physicalDevice,
 	deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
 	deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
 	deviceCreateInfo.flags = 0;
-	deviceCreateInfo.pNext = nullptr;
+	deviceCreateInfo.pNext = &vulkan12Features;
 
 	VkDevice device;
-	vkCreateDevice(physicalDevice, &deviceCreateInfo, nullptr, &device);
+	VULKAN_RHI_SAFE_CALL(vkCreateDevice(physicalDevice, &deviceCreateInfo, nullptr, &device));
 
 	return device;
 }
@@ -112,9 +210,24 @@ VulkanDevice::VulkanDevice(VulkanInstanceRef instance,
 {
 	physicalDevice = choosePhysicalDevice(instance->Instance());
 	graphicsFamilyIdx = findGraphicsFamilyIdx(physicalDevice);
-	presentFamilyIdx = findPresentFamilyIdx(physicalDevice, surface);
+	// Headless devices have no surface; presenting is never done, so the graphics queue stands in.
+	presentFamilyIdx = surface != VK_NULL_HANDLE ? findPresentFamilyIdx(physicalDevice, surface) : graphicsFamilyIdx;
+
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
+	bindless = supportsBindless(physicalDevice);
+	drawIndirectCount = supportsDrawIndirectCount(physicalDevice);
+	multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+	drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+	timestamps = supportsTimestamps(physicalDevice, getQueueFamilyProperties(physicalDevice)[graphicsFamilyIdx]);
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	timestampPeriod = properties.limits.timestampPeriod;
+
 	device = createDevice(physicalDevice, graphicsFamilyIdx, presentFamilyIdx,
-		deviceExtensions);
+		deviceExtensions, supportedFeatures, bindless, drawIndirectCount, timestamps);
 
 	vkGetDeviceQueue(device, graphicsFamilyIdx, 0, &graphicsQueue);
 	vkGetDeviceQueue(device, presentFamilyIdx, 0, &presentQueue);
@@ -150,6 +263,41 @@ const VkQueue& VulkanDevice::GraphicsQueue()
 	return graphicsQueue;
 }
 
+bool VulkanDevice::SupportsBindless() const
+{
+	return bindless;
+}
+
+bool VulkanDevice::SupportsDrawIndirectCount() const
+{
+	return drawIndirectCount;
+}
+
+bool VulkanDevice::SupportsMultiDrawIndirect() const
+{
+	return multiDrawIndirect;
+}
+
+bool VulkanDevice::SupportsDrawIndirectFirstInstance() const
+{
+	return drawIndirectFirstInstance;
+}
+
+bool VulkanDevice::SupportsTimestamps() const
+{
+	return timestamps;
+}
+
+float VulkanDevice::TimestampPeriod() const
+{
+	return timestampPeriod;
+}
+
+VulkanCounters& VulkanDevice::Counters()
+{
+	return counters;
+}
+
 const VkQueue& VulkanDevice::PresentQueue()
 {
 	return presentQueue;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "VulkanCounters.h"
 #include "VulkanInstance.h"
 
 #include <memory>
@@ -9,6 +10,7 @@
 class VulkanDevice
 {
 public:
+	// surface may be VK_NULL_HANDLE for a headless device.
 	VulkanDevice(VulkanInstanceRef instance,
 		const std::vector<const char*>& deviceExtensions,
 		VkSurfaceKHR surface);
@@ -27,6 +29,23 @@ public:
 
 	const VkQueue& PresentQueue();
 
+	bool SupportsBindless() const;
+
+	// vkCmdDrawIndexedIndirectCount and multi-draw indirect.
+	bool SupportsDrawIndirectCount() const;
+
+	bool SupportsMultiDrawIndirect() const;
+
+	bool SupportsDrawIndirectFirstInstance() const;
+
+	// Timestamp queries on the graphics queue, reset from the host.
+	bool SupportsTimestamps() const;
+
+	// Nanoseconds per timestamp tick.
+	float TimestampPeriod() const;
+
+	VulkanCounters& Counters();
+
 private:
 	VulkanInstanceRef instance;
 	VkDevice device;
@@ -35,6 +54,13 @@ private:
 	uint32_t presentFamilyIdx;
 	VkQueue graphicsQueue;
 	VkQueue presentQueue;
+	bool bindless;
+	bool drawIndirectCount;
+	bool multiDrawIndirect;
+	bool drawIndirectFirstInstance;
+	bool timestamps;
+	float timestampPeriod;
+	VulkanCounters counters;
 };
 
 using VulkanDeviceRef = std::shared_ptr<VulkanDevice>;
\ No newline at end of file
@@ -1,46 +1,7 @@
 #include "VulkanGraphicsPipeline.h"
+#include "Shared.h"
 #include "VulkanRenderPass.h"
 
-#include <map>
-
-VkDescriptorSetLayout CreateDescriptorSetLayout(
-	VkDevice device,
-	const std::vector<VkDescriptorSetLayoutBinding>& bindings)
-{
-	VkDescriptorSetLayoutCreateInfo createInfo;
-	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	createInfo.bindingCount = bindings.size();
-	createInfo.pBindings = bindings.data();
-	createInfo.flags = 0;
-	createInfo.pNext = nullptr;
-
-	VkDescriptorSetLayout result;
-
-	VULKAN_RHI_SAFE_CALL(
-		vkCreateDescriptorSetLayout(device, &createInfo, nullptr, &result));
-
-	return result;
-}
-
-VkPipelineLayout CreatePipelineLayout(
-	const VkDevice& device,
-	const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts)
-{
-	VkPipelineLayoutCreateInfo pipelineLayoutInfo;
-	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineLayoutInfo.setLayoutCount = descriptorSetLayouts.size();
-	pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-	pipelineLayoutInfo.pushConstantRangeCount = 0;
-	pipelineLayoutInfo.pPushConstantRanges = nullptr;
-	pipelineLayoutInfo.flags = 0;
-	pipelineLayoutInfo.pNext = nullptr;
-
-	VkPipelineLayout result;
-
-	VULKAN_RHI_SAFE_CALL(
-		vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &result));
-	return result;
-}
 
 // TODO: remove this
 VulkanRenderPassRef CreateDummyRenderPass(VulkanDeviceRef device,
@@ -119,9 +80,10 @@ VulkanRenderPassRef CreateDummyRenderPass(VulkanDeviceRef device,
 }
 
 VulkanGraphicsPipeline::VulkanGraphicsPipeline(
-	VulkanDeviceRef device, VkExtent2D extent, VkFormat surfaceFormat,
-	VkFormat depthFormat, const GraphicsPipelineCreateInfo& info)
-	: device(device)
+	VulkanDeviceRef device, VulkanDescriptorLayoutCacheRef layoutCache, VulkanBindlessTableRef bindlessTable,
+	VkPipelineCache pipelineCache, VkExtent2D extent, VkFormat surfaceFormat, VkFormat depthFormat,
+	const GraphicsPipelineCreateInfo& info)
+	: VulkanPipeline(device, layoutCache, bindlessTable, VK_PIPELINE_BIND_POINT_GRAPHICS)
 {
 	VulkanShader* vertexShader =
 		static_cast<VulkanShader*>(info.vertexShader.get());
@@ -292,27 +254,7 @@ VulkanGraphicsPipeline::VulkanGraphicsPipeline(
 	depthStencil.flags = 0;
 	depthStencil.pNext = nullptr;
 
-	std::map<int, std::vector<VkDescriptorSetLayoutBinding>> bindings;
-
-	for (auto& [set, b] : vertexShader->bindings) {
-		bindings[set].insert(bindings[set].end(), b.begin(), b.end());
-	}
-	for (auto& [set, b] : fragmentShader->bindings) {
-		bindings[set].insert(bindings[set].end(), b.begin(), b.end());
-	}
-
-	auto vertexParams = vertexShader->params;
-	auto fragmentParams = fragmentShader->params;
-
-	params.merge(vertexParams);
-	params.merge(fragmentParams);
-
-	for (auto& [set, b] : bindings) {
-		descriptorSetLayouts.push_back(
-			CreateDescriptorSetLayout(device->Device(), b));
-	}
-
-	layoutHandle = CreatePipelineLayout(device->Device(), descriptorSetLayouts);
+	createLayout({ vertexShader, fragmentShader });
 
 	VulkanRenderPassRef renderPass =
 		CreateDummyRenderPass(device, surfaceFormat, depthFormat);
@@ -338,32 +280,5 @@ VulkanGraphicsPipeline::VulkanGraphicsPipeline(
 	pipelineInfo.pNext = nullptr;
 
 	VULKAN_RHI_SAFE_CALL(vkCreateGraphicsPipelines(
-		device->Device(), nullptr, 1, &pipelineInfo, nullptr, &pipelineHandle));
-}
-
-VulkanGraphicsPipeline::~VulkanGraphicsPipeline()
-{
-	vkDestroyPipeline(device->Device(), pipelineHandle, nullptr);
-
-	vkDestroyPipelineLayout(device->Device(), layoutHandle, nullptr);
-
-	for (VkDescriptorSetLayout layout : descriptorSetLayouts) {
-		vkDestroyDescriptorSetLayout(device->Device(), layout, nullptr);
-	}
-}
-
-const std::vector<VkDescriptorSetLayout>&
-VulkanGraphicsPipeline::DescriptorLayouts() const
-{
-	return descriptorSetLayouts;
-}
-
-VkPipeline VulkanGraphicsPipeline::PipelineHandle() const
-{
-	return pipelineHandle;
-}
-
-VkPipelineLayout VulkanGraphicsPipeline::LayoutHandle() const
-{
-	return layoutHandle;
+		device->Device(), pipelineCache, 1, &pipelineInfo, nullptr, &pipelineHandle));
 }
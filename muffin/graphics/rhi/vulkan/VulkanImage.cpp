@@ -1,13 +1,20 @@
 #include "VulkanImage.h"
 
-VulkanImage::VulkanImage(VulkanDeviceRef device, VkImage img, VkDeviceMemory memory, VkImageView view)
-	: device(device), image(img), memory(memory), view(view)
+VulkanImage::VulkanImage(VulkanDeviceRef device, VulkanMemoryAllocatorRef allocator, VkImage img,
+	const VulkanAllocation& memory, VkImageView view)
+	: device(device), allocator(allocator), image(img), memory(memory), view(view),
+	  layout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
 {
+	device->Counters().texturesCreated++;
+	device->Counters().textureBytesCreated += memory.size;
 }
 
 VulkanImage::~VulkanImage()
 {
 	vkDestroyImageView(device->Device(), view, nullptr);
 	vkDestroyImage(device->Device(), image, nullptr);
-	vkFreeMemory(device->Device(), memory, nullptr);
+	allocator->Free(memory);
+
+	device->Counters().texturesDestroyed++;
+	device->Counters().textureBytesFreed += memory.size;
 }
\ No newline at end of file
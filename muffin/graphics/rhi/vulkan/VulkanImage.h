@@ -1,6 +1,7 @@
 #pragma once
 
 #include "VulkanDevice.h"
+#include "VulkanMemoryAllocator.h"
 #include "muffin/graphics/rhi/RHI.h"
 
 #include <vulkan/vulkan.h>
@@ -8,11 +9,16 @@
 struct VulkanImage : RHITexture
 {
 	VulkanDeviceRef device;
+	VulkanMemoryAllocatorRef allocator;
 	VkImage image;
-	VkDeviceMemory memory;
+	VulkanAllocation memory;
 	VkImageView view;
+	// Layout the image is in whenever shaders access it: SHADER_READ_ONLY_OPTIMAL for textures filled
+	// by uploads, GENERAL for storage textures.
+	VkImageLayout layout;
 
-	VulkanImage(VulkanDeviceRef device, VkImage img, VkDeviceMemory memory, VkImageView view);
+	VulkanImage(VulkanDeviceRef device, VulkanMemoryAllocatorRef allocator, VkImage img, const VulkanAllocation& memory,
+		VkImageView view);
 
 	virtual ~VulkanImage() override;
 };
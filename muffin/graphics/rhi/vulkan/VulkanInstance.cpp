@@ -1,6 +1,7 @@
 #include "VulkanInstance.h"
+#include "Shared.h"
 
-VkInstance createInstance(const std::vector<const char*>& enabledExtensions)
+VkInstance createInstance(const std::vector<const char*>& enabledExtensions, bool validation)
 {
 	VkApplicationInfo applicationInfo{};
 	applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -8,34 +9,35 @@ VkInstance createInstance(const std::vector<const char*>& enabledExtensions)
 	applicationInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 	applicationInfo.pEngineName = "Muffin";
 	applicationInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-	applicationInfo.apiVersion = VK_API_VERSION_1_0;
+	applicationInfo.apiVersion = VK_API_VERSION_1_2;
 	applicationInfo.pNext = nullptr;
 
 	// TODO: check extensions support
-	const std::vector<const char*> validationLayers = {
-		"VK_LAYER_KHRONOS_validation"
-	};
+	std::vector<const char*> layers;
+	if (validation) {
+		layers.push_back("VK_LAYER_KHRONOS_validation");
+	}
 
 	VkInstanceCreateInfo instanceCreateInfo{};
 	instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	instanceCreateInfo.pApplicationInfo = &applicationInfo;
 	instanceCreateInfo.enabledExtensionCount = (uint32_t)enabledExtensions.size();
 	instanceCreateInfo.ppEnabledExtensionNames = enabledExtensions.data();
-	instanceCreateInfo.enabledLayerCount = (uint32_t)validationLayers.size();
-	instanceCreateInfo.ppEnabledLayerNames = validationLayers.data();
+	instanceCreateInfo.enabledLayerCount = (uint32_t)layers.size();
+	instanceCreateInfo.ppEnabledLayerNames = layers.data();
 	instanceCreateInfo.flags = 0;
 	instanceCreateInfo.pNext = nullptr;
 
 	VkInstance result;
-	vkCreateInstance(&instanceCreateInfo, nullptr, &result);
+	VULKAN_RHI_SAFE_CALL(vkCreateInstance(&instanceCreateInfo, nullptr, &result));
 
 	return result;
 }
 
 VulkanInstance::VulkanInstance(
-	const std::vector<const char*>& enabledExtensions)
+	const std::vector<const char*>& enabledExtensions, bool validation)
 {
-	instance = createInstance(enabledExtensions);
+	instance = createInstance(enabledExtensions, validation);
 }
 
 VulkanInstance::~VulkanInstance()
@@ -7,7 +7,8 @@
 class VulkanInstance
 {
 public:
-	VulkanInstance(const std::vector<const char*>& enabledExtensions);
+	// validation enables VK_LAYER_KHRONOS_validation, which must be installed.
+	VulkanInstance(const std::vector<const char*>& enabledExtensions, bool validation);
 
 	virtual ~VulkanInstance();
 
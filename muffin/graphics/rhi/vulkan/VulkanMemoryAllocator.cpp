@@ -0,0 +1,259 @@
+#include "VulkanMemoryAllocator.h"
+#include "Shared.h"
+
+#include <stdexcept>
+
+static const uint32_t MAX_ORDER = [] {
+	uint32_t order = 0;
+	while ((MIN_SUBALLOCATION_SIZE << order) < MEMORY_BLOCK_SIZE) {
+		order++;
+	}
+	return order;
+}();
+
+uint32_t BuddyOrderForSize(VkDeviceSize size)
+{
+	uint32_t order = 0;
+	while ((MIN_SUBALLOCATION_SIZE << order) < size) {
+		order++;
+	}
+	return order;
+}
+
+void BuddyInit(VulkanMemoryBlock& block)
+{
+	block.freeLists.assign(MAX_ORDER + 1, {});
+	block.freeLists[MAX_ORDER].insert(0);
+}
+
+bool BuddyTake(VulkanMemoryBlock& block, uint32_t order, VkDeviceSize& offset)
+{
+	uint32_t current = order;
+	while (current <= MAX_ORDER && block.freeLists[current].empty()) {
+		current++;
+	}
+	if (current > MAX_ORDER) {
+		return false;
+	}
+
+	offset = *block.freeLists[current].begin();
+	block.freeLists[current].erase(block.freeLists[current].begin());
+
+	while (current > order) {
+		current--;
+		block.freeLists[current].insert(offset + (MIN_SUBALLOCATION_SIZE << current));
+	}
+	return true;
+}
+
+void BuddyRelease(VulkanMemoryBlock& block, uint32_t order, VkDeviceSize offset)
+{
+	while (order < MAX_ORDER) {
+		VkDeviceSize buddy = offset ^ (MIN_SUBALLOCATION_SIZE << order);
+		auto it = block.freeLists[order].find(buddy);
+		if (it == block.freeLists[order].end()) {
+			break;
+		}
+		block.freeLists[order].erase(it);
+		offset = std::min(offset, buddy);
+		order++;
+	}
+	block.freeLists[order].insert(offset);
+}
+
+VulkanMemoryAllocator::VulkanMemoryAllocator(VulkanDeviceRef device)
+	: device(device), usedBytes(0), allocationCount(0)
+{
+	vkGetPhysicalDeviceMemoryProperties(device->PhysicalDevice(), &memoryProperties);
+}
+
+VulkanMemoryAllocator::~VulkanMemoryAllocator()
+{
+	for (auto& pool : pools) {
+		for (auto& block : pool) {
+			vkFreeMemory(device->Device(), block->memory, nullptr);
+			device->Counters().memoryFrees++;
+		}
+	}
+}
+
+uint32_t VulkanMemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+{
+	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+		if (typeFilter & (1 << i) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+			return i;
+		}
+	}
+
+	throw std::runtime_error("failed to find suitable memory type!");
+}
+
+VulkanMemoryBlock* VulkanMemoryAllocator::createBlock(uint32_t memoryType, VkDeviceSize size, bool dedicated)
+{
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryType;
+	allocInfo.pNext = nullptr;
+
+	VkDeviceMemory memory;
+	if (vkAllocateMemory(device->Device(), &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate device memory!");
+	}
+	device->Counters().memoryAllocations++;
+
+	void* mapped = nullptr;
+	if (memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		VULKAN_RHI_SAFE_CALL(vkMapMemory(device->Device(), memory, 0, VK_WHOLE_SIZE, 0, &mapped));
+	}
+
+	VulkanMemoryBlock* block = new VulkanMemoryBlock{
+		.memory = memory,
+		.size = size,
+		.mapped = mapped,
+		.dedicated = dedicated,
+		.allocatedBytes = 0,
+	};
+
+	if (!dedicated) {
+		BuddyInit(*block);
+	}
+	return block;
+}
+
+void VulkanMemoryAllocator::destroyBlock(uint32_t pool, VulkanMemoryBlock* block)
+{
+	vkFreeMemory(device->Device(), block->memory, nullptr);
+	device->Counters().memoryFrees++;
+
+	auto& blocks = pools[pool];
+	for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+		if (it->get() == block) {
+			blocks.erase(it);
+			return;
+		}
+	}
+}
+
+VulkanAllocation VulkanMemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+	bool linear)
+{
+	uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+	uint32_t pool = memoryType * 2 + (linear ? 0 : 1);
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	VkDeviceSize size = std::max(requirements.size, requirements.alignment);
+
+	usedBytes += requirements.size;
+	allocationCount++;
+
+	if (size > MEMORY_BLOCK_SIZE / 2) {
+		VulkanMemoryBlock* block = createBlock(memoryType, requirements.size, true);
+		block->allocatedBytes = requirements.size;
+		pools[pool].emplace_back(block);
+		return VulkanAllocation{
+			.memory = block->memory,
+			.offset = 0,
+			.size = requirements.size,
+			.mapped = block->mapped,
+			.block = block,
+			.pool = pool,
+			.order = 0,
+		};
+	}
+
+	uint32_t order = BuddyOrderForSize(size);
+	VkDeviceSize offset = 0;
+
+	VulkanMemoryBlock* target = nullptr;
+	for (auto& block : pools[pool]) {
+		if (!block->dedicated && BuddyTake(*block, order, offset)) {
+			target = block.get();
+			break;
+		}
+	}
+
+	if (!target) {
+		target = createBlock(memoryType, MEMORY_BLOCK_SIZE, false);
+		pools[pool].emplace_back(target);
+		BuddyTake(*target, order, offset);
+	}
+
+	target->allocatedBytes += MIN_SUBALLOCATION_SIZE << order;
+
+	return VulkanAllocation{
+		.memory = target->memory,
+		.offset = offset,
+		.size = requirements.size,
+		.mapped = target->mapped ? (char*)target->mapped + offset : nullptr,
+		.block = target,
+		.pool = pool,
+		.order = order,
+	};
+}
+
+void VulkanMemoryAllocator::Free(const VulkanAllocation& allocation)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	usedBytes -= allocation.size;
+	allocationCount--;
+
+	VulkanMemoryBlock* block = allocation.block;
+
+	if (block->dedicated) {
+		destroyBlock(allocation.pool, block);
+		return;
+	}
+
+	BuddyRelease(*block, allocation.order, allocation.offset);
+	block->allocatedBytes -= MIN_SUBALLOCATION_SIZE << allocation.order;
+
+	// Keep one empty block per pool around so that allocation churn does not hit vkAllocateMemory.
+	if (block->allocatedBytes == 0) {
+		size_t emptyBlocks = 0;
+		for (auto& b : pools[allocation.pool]) {
+			if (!b->dedicated && b->allocatedBytes == 0) {
+				emptyBlocks++;
+			}
+		}
+		if (emptyBlocks > 1) {
+			destroyBlock(allocation.pool, block);
+		}
+	}
+}
+
+MemoryStats VulkanMemoryAllocator::GetStats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	MemoryStats stats;
+	stats.usedBytes = usedBytes;
+	stats.allocationCount = allocationCount;
+
+	VkDeviceSize freeBytes = 0;
+	VkDeviceSize largestFreeRange = 0;
+
+	for (auto& pool : pools) {
+		for (auto& block : pool) {
+			stats.reservedBytes += block->size;
+			stats.blockCount++;
+
+			if (block->dedicated) {
+				continue;
+			}
+
+			freeBytes += block->size - block->allocatedBytes;
+			for (uint32_t order = MAX_ORDER + 1; order-- > 0;) {
+				if (!block->freeLists[order].empty()) {
+					largestFreeRange = std::max(largestFreeRange, MIN_SUBALLOCATION_SIZE << order);
+					break;
+				}
+			}
+		}
+	}
+
+	stats.fragmentation = freeBytes ? 1.f - float(largestFreeRange) / float(freeBytes) : 0.f;
+	return stats;
+}
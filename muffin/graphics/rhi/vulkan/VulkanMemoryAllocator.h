@@ -0,0 +1,84 @@
+#pragma once
+
+#include "VulkanDevice.h"
+#include "muffin/graphics/rhi/RHI.h"
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+const VkDeviceSize MEMORY_BLOCK_SIZE = 64 * 1024 * 1024;
+const VkDeviceSize MIN_SUBALLOCATION_SIZE = 256;
+
+struct VulkanMemoryBlock
+{
+	VkDeviceMemory memory;
+	VkDeviceSize size;
+	void* mapped;
+	bool dedicated;
+
+	VkDeviceSize allocatedBytes;
+
+	// Buddy free lists, one per order: order k holds free ranges of MIN_SUBALLOCATION_SIZE << k bytes.
+	std::vector<std::set<VkDeviceSize>> freeLists;
+};
+
+// Buddy bookkeeping of a sub-allocated block, free of any Vulkan calls so it can be tested on its own.
+// Ranges of order k are aligned to their own size, MIN_SUBALLOCATION_SIZE << k.
+uint32_t BuddyOrderForSize(VkDeviceSize size);
+
+void BuddyInit(VulkanMemoryBlock& block);
+
+bool BuddyTake(VulkanMemoryBlock& block, uint32_t order, VkDeviceSize& offset);
+
+void BuddyRelease(VulkanMemoryBlock& block, uint32_t order, VkDeviceSize offset);
+
+struct VulkanAllocation
+{
+	VkDeviceMemory memory;
+	VkDeviceSize offset;
+	VkDeviceSize size;
+	void* mapped;
+
+	VulkanMemoryBlock* block;
+	uint32_t pool;
+	uint32_t order;
+};
+
+// Sub-allocates buffers and images out of large VkDeviceMemory blocks. Each memory type has
+// separate pools for linear and optimal resources so that bufferImageGranularity never has to be
+// taken into account inside a block.
+class VulkanMemoryAllocator
+{
+public:
+	explicit VulkanMemoryAllocator(VulkanDeviceRef device);
+
+	~VulkanMemoryAllocator();
+
+	VulkanAllocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear);
+
+	void Free(const VulkanAllocation& allocation);
+
+	MemoryStats GetStats();
+
+private:
+	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+
+	VulkanMemoryBlock* createBlock(uint32_t memoryType, VkDeviceSize size, bool dedicated);
+
+	void destroyBlock(uint32_t pool, VulkanMemoryBlock* block);
+
+	VulkanDeviceRef device;
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+
+	std::vector<std::unique_ptr<VulkanMemoryBlock>> pools[2 * VK_MAX_MEMORY_TYPES];
+
+	uint64_t usedBytes;
+	uint32_t allocationCount;
+
+	std::mutex mutex;
+};
+
+using VulkanMemoryAllocatorRef = std::shared_ptr<VulkanMemoryAllocator>;
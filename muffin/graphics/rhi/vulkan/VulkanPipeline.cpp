@@ -0,0 +1,147 @@
+#include "VulkanPipeline.h"
+#include "Shared.h"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+static VkPipelineLayout createPipelineLayout(
+	const VkDevice& device,
+	const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts,
+	const std::vector<VkPushConstantRange>& pushConstantRanges)
+{
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo;
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = descriptorSetLayouts.size();
+	pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+	pipelineLayoutInfo.pushConstantRangeCount = pushConstantRanges.size();
+	pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+	pipelineLayoutInfo.flags = 0;
+	pipelineLayoutInfo.pNext = nullptr;
+
+	VkPipelineLayout result;
+
+	VULKAN_RHI_SAFE_CALL(
+		vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &result));
+	return result;
+}
+
+VulkanPipeline::VulkanPipeline(VulkanDeviceRef device, VulkanDescriptorLayoutCacheRef layoutCache,
+	VulkanBindlessTableRef bindlessTable, VkPipelineBindPoint bindPoint)
+	: device(device), layoutCache(layoutCache), bindlessTable(bindlessTable), bindPoint(bindPoint),
+	  layoutHandle(VK_NULL_HANDLE), pipelineHandle(VK_NULL_HANDLE), bindlessSet(-1)
+{
+}
+
+void VulkanPipeline::createLayout(const std::vector<VulkanShader*>& stages)
+{
+	std::map<int, std::vector<VkDescriptorSetLayoutBinding>> bindings;
+
+	for (VulkanShader* shader : stages) {
+		for (auto& [set, b] : shader->bindings) {
+			bindings[set].insert(bindings[set].end(), b.begin(), b.end());
+		}
+		params.insert(shader->params.begin(), shader->params.end());
+	}
+
+	for (VulkanShader* shader : stages) {
+		if (shader->bindlessSet == -1) {
+			continue;
+		}
+		if (!bindlessTable) {
+			throw std::runtime_error("shader uses bindless arrays but the device does not support them");
+		}
+		if (bindlessSet != -1 && bindlessSet != shader->bindlessSet) {
+			throw std::runtime_error("shader stages disagree on the bindless descriptor set");
+		}
+		if (bindings.count(shader->bindlessSet)) {
+			throw std::runtime_error("the bindless descriptor set cannot hold other bindings");
+		}
+		bindlessSet = shader->bindlessSet;
+	}
+
+	// Unused set numbers below the highest one get empty layouts.
+	int setCount = std::max(bindings.empty() ? 0 : bindings.rbegin()->first + 1, bindlessSet + 1);
+	for (int set = 0; set < setCount; set++) {
+		if (set == bindlessSet) {
+			descriptorSetLayouts.push_back(bindlessTable->Layout());
+		} else {
+			descriptorSetLayouts.push_back(layoutCache->Get(bindings.count(set) ? bindings[set] : std::vector<VkDescriptorSetLayoutBinding>{}));
+		}
+	}
+
+	// Stages declaring the same block share one range; otherwise each stage keeps its own.
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device->PhysicalDevice(), &properties);
+
+	for (VulkanShader* shader : stages) {
+		for (const VkPushConstantRange& range : shader->pushConstantRanges) {
+			if (range.offset + range.size > properties.limits.maxPushConstantsSize) {
+				throw std::runtime_error("push constant block exceeds maxPushConstantsSize");
+			}
+
+			auto same = std::find_if(pushConstantRanges.begin(), pushConstantRanges.end(), [&](const VkPushConstantRange& r) {
+				return r.offset == range.offset && r.size == range.size;
+			});
+			if (same != pushConstantRanges.end()) {
+				same->stageFlags |= range.stageFlags;
+			} else {
+				pushConstantRanges.push_back(range);
+			}
+		}
+	}
+
+	layoutHandle = createPipelineLayout(device->Device(), descriptorSetLayouts, pushConstantRanges);
+}
+
+VulkanPipeline::~VulkanPipeline()
+{
+	vkDestroyPipeline(device->Device(), pipelineHandle, nullptr);
+
+	vkDestroyPipelineLayout(device->Device(), layoutHandle, nullptr);
+}
+
+const std::vector<VkDescriptorSetLayout>& VulkanPipeline::DescriptorLayouts() const
+{
+	return descriptorSetLayouts;
+}
+
+const std::vector<VkPushConstantRange>& VulkanPipeline::PushConstantRanges() const
+{
+	return pushConstantRanges;
+}
+
+VkShaderStageFlags VulkanPipeline::PushConstantStages(uint32_t offset, uint32_t size) const
+{
+	VkShaderStageFlags stages = 0;
+	for (const VkPushConstantRange& range : pushConstantRanges) {
+		if (offset >= range.offset + range.size || offset + size <= range.offset) {
+			continue;
+		}
+		if (offset < range.offset || offset + size > range.offset + range.size) {
+			throw std::runtime_error("push constant update straddles a stage's range");
+		}
+		stages |= range.stageFlags;
+	}
+	return stages;
+}
+
+VkPipelineBindPoint VulkanPipeline::BindPoint() const
+{
+	return bindPoint;
+}
+
+int VulkanPipeline::BindlessSet() const
+{
+	return bindlessSet;
+}
+
+VkPipeline VulkanPipeline::PipelineHandle() const
+{
+	return pipelineHandle;
+}
+
+VkPipelineLayout VulkanPipeline::LayoutHandle() const
+{
+	return layoutHandle;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "VulkanBindlessTable.h"
+#include "VulkanDescriptorLayoutCache.h"
+#include "VulkanDevice.h"
+#include "VulkanShader.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Pipeline layout and reflected parameters shared by graphics and compute pipelines. Derived
+// classes call createLayout() with their stages and then create pipelineHandle against layoutHandle.
+class VulkanPipeline
+{
+public:
+	virtual ~VulkanPipeline();
+
+	VkPipelineBindPoint BindPoint() const;
+
+	const std::vector<VkDescriptorSetLayout>& DescriptorLayouts() const;
+
+	const std::vector<VkPushConstantRange>& PushConstantRanges() const;
+
+	// Stages whose range overlaps [offset, offset + size), i.e. the stage flags vkCmdPushConstants needs.
+	VkShaderStageFlags PushConstantStages(uint32_t offset, uint32_t size) const;
+
+	// Set the bindless table is bound to, or -1.
+	int BindlessSet() const;
+
+	VkPipeline PipelineHandle() const;
+
+	VkPipelineLayout LayoutHandle() const;
+
+	std::unordered_map<std::string, DescriptorSetBindingPoint> params;
+
+protected:
+	VulkanPipeline(VulkanDeviceRef device, VulkanDescriptorLayoutCacheRef layoutCache, VulkanBindlessTableRef bindlessTable,
+		VkPipelineBindPoint bindPoint);
+
+	void createLayout(const std::vector<VulkanShader*>& stages);
+
+	VulkanDeviceRef device;
+	VulkanDescriptorLayoutCacheRef layoutCache;
+	VulkanBindlessTableRef bindlessTable;
+	VkPipelineBindPoint bindPoint;
+
+	VkPipelineLayout layoutHandle;
+	VkPipeline pipelineHandle;
+
+	// Owned by layoutCache.
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	std::vector<VkPushConstantRange> pushConstantRanges;
+	int bindlessSet;
+	std::vector<RHIShaderRef> shaders;
+};
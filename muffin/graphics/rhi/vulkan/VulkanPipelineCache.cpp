@@ -0,0 +1,84 @@
+#include "VulkanPipelineCache.h"
+#include "Shared.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+VulkanPipelineCache::VulkanPipelineCache(VulkanDeviceRef device, const std::string& path)
+	: device(device), path(path)
+{
+	std::ifstream file(path, std::ios::binary);
+	std::string data;
+	if (file.is_open()) {
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+	if (!validHeader(data)) {
+		data.clear();
+	}
+
+	VkPipelineCacheCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = data.size();
+	createInfo.pInitialData = data.data();
+	createInfo.flags = 0;
+	createInfo.pNext = nullptr;
+
+	VULKAN_RHI_SAFE_CALL(vkCreatePipelineCache(device->Device(), &createInfo, nullptr, &cache));
+}
+
+VulkanPipelineCache::~VulkanPipelineCache()
+{
+	vkDestroyPipelineCache(device->Device(), cache, nullptr);
+}
+
+VkPipelineCache VulkanPipelineCache::Handle() const
+{
+	return cache;
+}
+
+void VulkanPipelineCache::Save()
+{
+	size_t size = 0;
+	if (vkGetPipelineCacheData(device->Device(), cache, &size, nullptr) != VK_SUCCESS || size == 0) {
+		return;
+	}
+
+	std::vector<char> data(size);
+	if (vkGetPipelineCacheData(device->Device(), cache, &size, data.data()) != VK_SUCCESS) {
+		return;
+	}
+
+	// Written next to the old file and renamed over it, so a crash mid-write cannot leave a truncated cache.
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.write(data.data(), size)) {
+			return;
+		}
+	}
+	// POSIX rename replaces the target atomically; Windows refuses to, so only there is the old file removed first.
+	if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+		std::remove(path.c_str());
+		std::rename(tempPath.c_str(), path.c_str());
+	}
+}
+
+bool VulkanPipelineCache::validHeader(const std::string& data) const
+{
+	VkPipelineCacheHeaderVersionOne header;
+	if (data.size() < sizeof(header)) {
+		return false;
+	}
+	memcpy(&header, data.data(), sizeof(header));
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device->PhysicalDevice(), &properties);
+
+	return header.headerSize >= sizeof(header) && header.headerSize <= data.size() &&
+		header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && header.vendorID == properties.vendorID &&
+		header.deviceID == properties.deviceID &&
+		memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "VulkanDevice.h"
+
+#include <memory>
+#include <string>
+#include <vulkan/vulkan.h>
+
+// VkPipelineCache that outlives the process: seeded from a file at startup and written back by Save, so
+// pipelines compiled in one run are only looked up in the next. Files written for another GPU or driver
+// are ignored rather than handed to the driver.
+class VulkanPipelineCache
+{
+public:
+	VulkanPipelineCache(VulkanDeviceRef device, const std::string& path);
+
+	~VulkanPipelineCache();
+
+	VkPipelineCache Handle() const;
+
+	// Writes the cache to the path it was loaded from. Failures are ignored; the next run just compiles again.
+	void Save();
+
+private:
+	// Whether data starts with a cache header written by this vendor, device and driver (pipeline cache UUID).
+	bool validHeader(const std::string& data) const;
+
+	VulkanDeviceRef device;
+	std::string path;
+	VkPipelineCache cache;
+};
+
+using VulkanPipelineCacheRef = std::shared_ptr<VulkanPipelineCache>;
@@ -1,28 +1,15 @@
 #include "VulkanRHI.h"
 #include "VulkanBuffer.h"
-#include "VulkanDescriptorSet.h"
+#include "VulkanComputePipeline.h"
 #include "VulkanGraphicsPipeline.h"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_vulkan.h>
+#include <algorithm>
+#include <chrono>
 #include <limits>
 #include <spirv_cross/spirv_cross.hpp>
 
-uint32_t
-findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties)
-{
-	VkPhysicalDeviceMemoryProperties memoryProperties;
-	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
-
-	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
-		if (typeFilter & (1 << i) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-			return i;
-		}
-	}
-
-	throw std::runtime_error("failed to find suitable memory type!");
-}
-
 VkSurfaceKHR createSurface(VkInstance instance, SDL_Window* window)
 {
 	VkSurfaceKHR surface;
@@ -36,7 +23,7 @@ VulkanCommandPoolRef createCommandPool(VulkanDeviceRef device, uint32_t graphics
 {
 	VkCommandPoolCreateInfo commandPoolCreateInfo{};
 	commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 	commandPoolCreateInfo.queueFamilyIndex = graphicsFamilyIdx;
 	commandPoolCreateInfo.pNext = nullptr;
 
@@ -46,12 +33,12 @@ VulkanCommandPoolRef createCommandPool(VulkanDeviceRef device, uint32_t graphics
 	return VulkanCommandPoolRef(new VulkanCommandPool(device, commandPool));
 }
 
-VkCommandBuffer createCommandBuffer(VkDevice device, VkCommandPool commandPool)
+VkCommandBuffer createCommandBuffer(VkDevice device, VkCommandPool commandPool, VkCommandBufferLevel level)
 {
 	VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
 	commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 	commandBufferAllocateInfo.commandPool = commandPool;
-	commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	commandBufferAllocateInfo.level = level;
 	commandBufferAllocateInfo.commandBufferCount = 1;
 	commandBufferAllocateInfo.pNext = nullptr;
 
@@ -183,32 +170,8 @@ createSwapchainImageViews(VkSwapchainKHR swapchain, VkDevice device,
 	return imageViews;
 }
 
-VulkanDescriptorPoolRef createDescriptorPool(VulkanDeviceRef device)
-{
-	VkDescriptorPoolSize poolSizes[2];
-	poolSizes[0].descriptorCount = 4096;
-	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-
-	poolSizes[1].descriptorCount = 4096;
-	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-
-	VkDescriptorPoolCreateInfo createInfo{};
-	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	createInfo.poolSizeCount = 2;
-	createInfo.pPoolSizes = poolSizes;
-	createInfo.maxSets = 1000;
-	createInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-	createInfo.pNext = nullptr;
-
-	VkDescriptorPool descriptorPool;
-
-	vkCreateDescriptorPool(device->Device(), &createInfo, nullptr, &descriptorPool);
-
-	return VulkanDescriptorPoolRef(new VulkanDescriptorPool(device, descriptorPool));
-}
-
 VulkanImageRef
-createImageImpl(VulkanDeviceRef device, VkPhysicalDevice physicalDevice, uint32_t width, uint32_t height,
+createImageImpl(VulkanDeviceRef device, VulkanMemoryAllocatorRef allocator, uint32_t width, uint32_t height,
 	VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
 	VkMemoryPropertyFlags memoryPorperties, VkImageAspectFlagBits aspectMask)
 {
@@ -236,16 +199,9 @@ createImageImpl(VulkanDeviceRef device, VkPhysicalDevice physicalDevice, uint32_
 	VkMemoryRequirements memReq;
 	vkGetImageMemoryRequirements(device->Device(), image, &memReq);
 
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memReq.size;
-	allocInfo.memoryTypeIndex = findMemoryType(physicalDevice, memReq.memoryTypeBits, memoryPorperties);
-	allocInfo.pNext = nullptr;
-
-	VkDeviceMemory memory;
-	vkAllocateMemory(device->Device(), &allocInfo, nullptr, &memory);
+	VulkanAllocation memory = allocator->Allocate(memReq, memoryPorperties, tiling == VK_IMAGE_TILING_LINEAR);
 
-	vkBindImageMemory(device->Device(), image, memory, 0);
+	vkBindImageMemory(device->Device(), image, memory.memory, memory.offset);
 
 	VkImageViewCreateInfo viewInfo{};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -263,7 +219,7 @@ createImageImpl(VulkanDeviceRef device, VkPhysicalDevice physicalDevice, uint32_
 	VkImageView imageView;
 	vkCreateImageView(device->Device(), &viewInfo, nullptr, &imageView);
 
-	return std::make_shared<VulkanImage>(device, image, memory, imageView);
+	return std::make_shared<VulkanImage>(device, allocator, image, memory, imageView);
 }
 
 VkDescriptorSetLayout
@@ -390,11 +346,11 @@ VkFormat findDepthFormat(VkPhysicalDevice physicalDevice)
 }
 
 VulkanImageRef
-createDepthImage(VulkanRHI& rhi, VulkanDeviceRef device, VkPhysicalDevice physicalDevice, uint32_t width,
+createDepthImage(VulkanRHI& rhi, VulkanDeviceRef device, VulkanMemoryAllocatorRef allocator, uint32_t width,
 	uint32_t height)
 {
-	VkFormat depthFormat = findDepthFormat(physicalDevice);
-	VulkanImageRef image = createImageImpl(device, physicalDevice, width, height, depthFormat, VK_IMAGE_TILING_OPTIMAL,
+	VkFormat depthFormat = findDepthFormat(device->PhysicalDevice());
+	VulkanImageRef image = createImageImpl(device, allocator, width, height, depthFormat, VK_IMAGE_TILING_OPTIMAL,
 		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
 
 	transitionImageLayout(rhi, image->image, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
@@ -415,7 +371,7 @@ VulkanRenderPassRef VulkanRHI::createRenderPass(int imgIdx)
 	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	colorAttachment.finalLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 	colorAttachment.flags = 0;
 
 	VkAttachmentReference colorAttachmentRef{};
@@ -454,6 +410,17 @@ VulkanRenderPassRef VulkanRHI::createRenderPass(int imgIdx)
 	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
+	// Lets ReadbackFrame copy the offscreen image without a barrier of its own.
+	VkSubpassDependency readbackDependency{};
+	readbackDependency.srcSubpass = 0;
+	readbackDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+	readbackDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	readbackDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	readbackDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	readbackDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	std::array<VkSubpassDependency, 2> dependencies = { dependency, readbackDependency };
+
 	std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
 	VkRenderPassCreateInfo renderPassInfo{};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -461,8 +428,8 @@ VulkanRenderPassRef VulkanRHI::createRenderPass(int imgIdx)
 	renderPassInfo.pAttachments = attachments.data();
 	renderPassInfo.subpassCount = 1;
 	renderPassInfo.pSubpasses = &subpass;
-	renderPassInfo.dependencyCount = 1;
-	renderPassInfo.pDependencies = &dependency;
+	renderPassInfo.dependencyCount = headless ? 2 : 1;
+	renderPassInfo.pDependencies = dependencies.data();
 	renderPassInfo.flags = 0;
 	renderPassInfo.pNext = nullptr;
 
@@ -475,10 +442,38 @@ VulkanRenderPassRef VulkanRHI::createRenderPass(int imgIdx)
 	return renderPassCache.at(imgIdx);
 }
 
+// The live pipeline created from info, if any. Expired entries are dropped first.
+template <typename Info, typename Pipeline>
+std::shared_ptr<Pipeline> findPipeline(std::map<Info, std::weak_ptr<Pipeline>>& pipelines, const Info& info)
+{
+	std::erase_if(pipelines, [](const auto& entry) { return entry.second.expired(); });
+
+	auto it = pipelines.find(info);
+	return it != pipelines.end() ? it->second.lock() : nullptr;
+}
+
 RHIGraphicsPipelineRef VulkanRHI::CreateGraphicsPipeline(const GraphicsPipelineCreateInfo& info)
 {
-	return RHIGraphicsPipelineRef(
-		new VulkanGraphicsPipeline(device, extent, surfaceFormat.format, findDepthFormat(device->PhysicalDevice()), info));
+	if (RHIGraphicsPipelineRef pipeline = findPipeline(graphicsPipelines, info)) {
+		return pipeline;
+	}
+
+	RHIGraphicsPipelineRef pipeline(new VulkanGraphicsPipeline(device, descriptorLayoutCache, bindlessTable,
+		pipelineCache->Handle(), extent, surfaceFormat.format, findDepthFormat(device->PhysicalDevice()), info));
+	graphicsPipelines[info] = pipeline;
+	return pipeline;
+}
+
+RHIComputePipelineRef VulkanRHI::CreateComputePipeline(const ComputePipelineCreateInfo& info)
+{
+	if (RHIComputePipelineRef pipeline = findPipeline(computePipelines, info)) {
+		return pipeline;
+	}
+
+	RHIComputePipelineRef pipeline(
+		new VulkanComputePipeline(device, descriptorLayoutCache, bindlessTable, pipelineCache->Handle(), info));
+	computePipelines[info] = pipeline;
+	return pipeline;
 }
 
 VkFramebuffer
@@ -533,21 +528,22 @@ std::vector<VkPresentModeKHR> getSurfacePresentModes(VkPhysicalDevice physicalDe
 	return presentModes;
 }
 
-VulkanRHI::VulkanRHI()
+VulkanRHI::VulkanRHI(bool validation)
+	: window(new VulkanWindow()), headless(false)
 {
 	uint32_t extensionsCount;
-	SDL_Vulkan_GetInstanceExtensions(window.window, &extensionsCount, nullptr);
-	SDL_Vulkan_GetInstanceExtensions(window.window, &extensionsCount, nullptr);
+	SDL_Vulkan_GetInstanceExtensions(window->window, &extensionsCount, nullptr);
+	SDL_Vulkan_GetInstanceExtensions(window->window, &extensionsCount, nullptr);
 	std::vector<const char*> enabledExtensions(extensionsCount);
-	SDL_Vulkan_GetInstanceExtensions(window.window, &extensionsCount, enabledExtensions.data());
+	SDL_Vulkan_GetInstanceExtensions(window->window, &extensionsCount, enabledExtensions.data());
 
 	const std::vector<const char*> deviceExtensions = {
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME
 	};
 
-	instance = VulkanInstanceRef(new VulkanInstance(enabledExtensions));
+	instance = VulkanInstanceRef(new VulkanInstance(enabledExtensions, validation));
 
-	surface = createSurface(instance->Instance(), window.window);
+	surface = createSurface(instance->Instance(), window->window);
 
 	device = VulkanDeviceRef(new VulkanDevice(instance, deviceExtensions, surface));
 
@@ -555,16 +551,51 @@ VulkanRHI::VulkanRHI()
 	presentMode = chooseSwapPresentMode(getSurfacePresentModes(device->PhysicalDevice(), surface));
 
 	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device->PhysicalDevice(), surface, &caps);
-	extent = chooseSwapExtent(caps, window.width, window.height);
+	extent = chooseSwapExtent(caps, window->width, window->height);
 
 	swapchain = createSwapchain(surface, device->Device(), surfaceFormat, presentMode, caps, extent,
 		device->GraphicsFamily(), device->PresentFamily());
 
 	swapchainImageViews = createSwapchainImageViews(swapchain, device->Device(), surfaceFormat, extent);
 
-	commandPool = createCommandPool(device, device->GraphicsFamily());
+	createResources();
+}
+
+VulkanRHI::VulkanRHI(uint32_t width, uint32_t height, bool validation)
+	: headless(true)
+{
+	instance = VulkanInstanceRef(new VulkanInstance({}, validation));
+
+	surface = VK_NULL_HANDLE;
+	swapchain = VK_NULL_HANDLE;
+
+	device = VulkanDeviceRef(new VulkanDevice(instance, {}, VK_NULL_HANDLE));
+
+	// RGBA rather than the swapchain's usual BGRA, so readback needs no swizzle.
+	surfaceFormat = VkSurfaceFormatKHR{ VK_FORMAT_R8G8B8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+	extent = VkExtent2D{ width, height };
+
+	createResources();
+
+	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+		offscreenImages[i] = createImageImpl(device, allocator, width, height, surfaceFormat.format, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			VK_IMAGE_ASPECT_COLOR_BIT);
+	}
+}
+
+void VulkanRHI::createResources()
+{
+	allocator = std::make_shared<VulkanMemoryAllocator>(device);
+
+	descriptorLayoutCache = std::make_shared<VulkanDescriptorLayoutCache>(device);
+	pipelineCache = std::make_shared<VulkanPipelineCache>(device, PIPELINE_CACHE_FILE);
+
+	if (device->SupportsBindless()) {
+		bindlessTable = std::make_shared<VulkanBindlessTable>(device, MAX_FRAMES_IN_FLIGHT);
+	}
 
-	descriptorPool = createDescriptorPool(device);
+	uploadQueue = std::make_shared<VulkanUploadQueue>(device, allocator, device->GraphicsQueue(), device->GraphicsFamily());
 
 	VkSemaphoreCreateInfo semaphoreInfo{};
 	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -576,14 +607,36 @@ VulkanRHI::VulkanRHI()
 	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 	fenceInfo.pNext = nullptr;
 
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device->PhysicalDevice(), &properties);
+
 	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
 		vkCreateSemaphore(device->Device(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]);
 		vkCreateSemaphore(device->Device(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]);
 		vkCreateFence(device->Device(), &fenceInfo, nullptr, &inFlightFences[i]);
+
+		commandPools[i] = createCommandPool(device, device->GraphicsFamily());
+		descriptorCaches[i] = std::make_shared<VulkanDescriptorCache>(device);
+		usedCommandLists[i] = 0;
+		usedSecondaryCommandLists[i] = 0;
+
+		uniformRings[i] = std::make_shared<VulkanRingBuffer>(device, allocator, UNIFORM_RING_PAGE_SIZE,
+			properties.limits.minUniformBufferOffsetAlignment, BufferInfo{ BufferUsage::Uniform });
+		vertexRings[i] = std::make_shared<VulkanRingBuffer>(device, allocator, VERTEX_RING_PAGE_SIZE, 16,
+			BufferInfo{ .usage = BufferUsage::Vertex, .dynamic = true });
+		indexRings[i] = std::make_shared<VulkanRingBuffer>(device, allocator, INDEX_RING_PAGE_SIZE, 4,
+			BufferInfo{ .usage = BufferUsage::Index, .dynamic = true });
+		storageRings[i] = std::make_shared<VulkanRingBuffer>(device, allocator, STORAGE_RING_PAGE_SIZE,
+			properties.limits.minStorageBufferOffsetAlignment, BufferInfo{ .usage = BufferUsage::Storage, .dynamic = true });
+
+		if (device->SupportsTimestamps()) {
+			timestampPools[i] = std::make_shared<VulkanTimestampPool>(device, TIMESTAMP_REGIONS_PER_FRAME);
+		}
 	}
 	currentFrame = 0;
+	frameNumber = 0;
 
-	depthImage = createDepthImage(*this, device, device->PhysicalDevice(), extent.width, extent.height);
+	depthImage = createDepthImage(*this, device, allocator, extent.width, extent.height);
 }
 
 #include <iostream>
@@ -675,6 +728,36 @@ VertexElementType spirvToVertexElementType(spirv_cross::SPIRType type)
 	return VertexElementType::None;
 }
 
+static VkShaderStageFlagBits shaderStage(ShaderType type)
+{
+	switch (type) {
+		case ShaderType::Vertex:
+			return VK_SHADER_STAGE_VERTEX_BIT;
+		case ShaderType::Fragment:
+			return VK_SHADER_STAGE_FRAGMENT_BIT;
+		case ShaderType::Compute:
+			return VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+	throw std::runtime_error("unknown shader type");
+}
+
+static bool isRuntimeArray(const spirv_cross::SPIRType& type)
+{
+	return type.array.size() == 1 && type.array[0] == 0 && type.array_size_literal[0];
+}
+
+static void setBindless(VulkanShader& shader, int set, int binding, uint32_t expectedBinding)
+{
+	if (binding != (int)expectedBinding) {
+		throw std::runtime_error("bindless array declared at binding " + std::to_string(binding) + ", expected " +
+			std::to_string(expectedBinding));
+	}
+	if (shader.bindlessSet != -1 && shader.bindlessSet != set) {
+		throw std::runtime_error("bindless arrays must all be in one descriptor set");
+	}
+	shader.bindlessSet = set;
+}
+
 RHIShaderRef VulkanRHI::CreateShader(const std::vector<uint32_t>& code, ShaderType type)
 {
 	VkShaderModuleCreateInfo createInfo{};
@@ -696,7 +779,14 @@ RHIShaderRef VulkanRHI::CreateShader(const std::vector<uint32_t>& code, ShaderTy
 
 	if (type == ShaderType::Vertex) {
 		int i = 0;
+		std::vector<spirv_cross::Resource> instanceInputs;
+
 		for (auto& b : resources.stage_inputs) {
+			if (b.name.rfind(INSTANCE_INPUT_PREFIX, 0) == 0) {
+				instanceInputs.push_back(b);
+				continue;
+			}
+
 			VkVertexInputAttributeDescription attributeDescription{};
 			attributeDescription.binding = i;
 			attributeDescription.location = comp.get_decoration(b.id, spv::DecorationLocation);
@@ -714,6 +804,39 @@ RHIShaderRef VulkanRHI::CreateShader(const std::vector<uint32_t>& code, ShaderTy
 
 			i++;
 		}
+
+		// Per-instance inputs are interleaved in location order into a single buffer at INSTANCE_BUFFER_BINDING.
+		// Matrices occupy one location per column.
+		std::sort(instanceInputs.begin(), instanceInputs.end(), [&](const auto& a, const auto& b) {
+			return comp.get_decoration(a.id, spv::DecorationLocation) < comp.get_decoration(b.id, spv::DecorationLocation);
+		});
+
+		uint32_t instanceStride = 0;
+		for (auto& b : instanceInputs) {
+			const spirv_cross::SPIRType& spirType = comp.get_type(b.type_id);
+			VertexElementType elementType = spirType.vecsize == 4 ? VertexElementType::Float4 : spirvToVertexElementType(spirType);
+			uint32_t location = comp.get_decoration(b.id, spv::DecorationLocation);
+
+			for (uint32_t column = 0; column < spirType.columns; column++) {
+				VkVertexInputAttributeDescription attributeDescription{};
+				attributeDescription.binding = INSTANCE_BUFFER_BINDING;
+				attributeDescription.location = location + column;
+				attributeDescription.offset = instanceStride;
+				attributeDescription.format = toVkBufferFormat(elementType);
+
+				res->vertexAttributes.push_back(attributeDescription);
+				instanceStride += getTypeSize(elementType);
+			}
+		}
+
+		if (instanceStride) {
+			VkVertexInputBindingDescription bindingDescription{};
+			bindingDescription.binding = INSTANCE_BUFFER_BINDING;
+			bindingDescription.stride = instanceStride;
+			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+			res->vertexBindings.push_back(bindingDescription);
+		}
 	}
 
 	for (auto& ub : resources.uniform_buffers) {
@@ -725,15 +848,8 @@ RHIShaderRef VulkanRHI::CreateShader(const std::vector<uint32_t>& code, ShaderTy
 		VkDescriptorSetLayoutBinding layoutBinding{};
 		layoutBinding.binding = binding;
 		layoutBinding.descriptorCount = 1;
-		layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		switch (type) {
-			case ShaderType::Vertex:
-				layoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-				break;
-			case ShaderType::Fragment:
-				layoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-				break;
-		}
+		layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		layoutBinding.stageFlags = shaderStage(type);
 		layoutBinding.pImmutableSamplers = nullptr;
 
 		res->bindings[set].push_back(layoutBinding);
@@ -743,59 +859,153 @@ RHIShaderRef VulkanRHI::CreateShader(const std::vector<uint32_t>& code, ShaderTy
 		int binding = comp.get_decoration(ub.id, spv::DecorationBinding);
 		int set = comp.get_decoration(ub.id, spv::DecorationDescriptorSet);
 
+		if (isRuntimeArray(comp.get_type(ub.type_id))) {
+			setBindless(*res, set, binding, BINDLESS_TEXTURE_BINDING);
+			continue;
+		}
+
 		res->params[ub.name] = { set, binding };
 
 		VkDescriptorSetLayoutBinding layoutBinding{};
 		layoutBinding.binding = binding;
 		layoutBinding.descriptorCount = 1;
 		layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		layoutBinding.stageFlags = shaderStage(type);
+		layoutBinding.pImmutableSamplers = nullptr;
+		res->bindings[set].push_back(layoutBinding);
+	}
 
-		switch (type) {
-			case ShaderType::Vertex:
-				layoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-				break;
-			case ShaderType::Fragment:
-				layoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-				break;
+	for (auto& sb : resources.storage_buffers) {
+		int binding = comp.get_decoration(sb.id, spv::DecorationBinding);
+		int set = comp.get_decoration(sb.id, spv::DecorationDescriptorSet);
+
+		if (isRuntimeArray(comp.get_type(sb.type_id))) {
+			setBindless(*res, set, binding, BINDLESS_BUFFER_BINDING);
+			continue;
 		}
+
+		res->params[sb.name] = { set, binding };
+
+		VkDescriptorSetLayoutBinding layoutBinding{};
+		layoutBinding.binding = binding;
+		layoutBinding.descriptorCount = 1;
+		layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+		layoutBinding.stageFlags = shaderStage(type);
 		layoutBinding.pImmutableSamplers = nullptr;
 		res->bindings[set].push_back(layoutBinding);
 	}
 
+	for (auto& si : resources.storage_images) {
+		int binding = comp.get_decoration(si.id, spv::DecorationBinding);
+		int set = comp.get_decoration(si.id, spv::DecorationDescriptorSet);
+
+		res->params[si.name] = { set, binding };
+
+		VkDescriptorSetLayoutBinding layoutBinding{};
+		layoutBinding.binding = binding;
+		layoutBinding.descriptorCount = 1;
+		layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		layoutBinding.stageFlags = shaderStage(type);
+		layoutBinding.pImmutableSamplers = nullptr;
+		res->bindings[set].push_back(layoutBinding);
+	}
+
+	for (auto& pc : resources.push_constant_buffers) {
+		const spirv_cross::SPIRType& blockType = comp.get_type(pc.base_type_id);
+
+		// The range starts at the first member so blocks laid out with offset() can share the space between stages.
+		uint32_t offset = comp.get_member_decoration(pc.base_type_id, 0, spv::DecorationOffset);
+
+		VkPushConstantRange range{};
+		range.offset = offset;
+		range.size = comp.get_declared_struct_size(blockType) - offset;
+		range.stageFlags = shaderStage(type);
+
+		res->pushConstantRanges.push_back(range);
+	}
+
 	return res;
 }
 
 void VulkanRHI::Submit(RHICommandListRef& commandList)
 {
 	VulkanCommandList& vulkanCommandList = static_cast<VulkanCommandList&>(*commandList);
+
+	uint64_t uploadValue = uploadQueue->Flush();
+
+	VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame], uploadQueue->Semaphore() };
+	// Uploaded buffers can be read by copies, compute and indirect draws as well as by the draws themselves.
+	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT };
+	uint64_t waitValues[] = { 0, uploadValue };
+	// Headless frames have no image to acquire, so only the uploads are waited for.
+	uint32_t firstWait = headless ? 1 : 0;
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = 2 - firstWait;
+	timelineInfo.pWaitSemaphoreValues = waitValues + firstWait;
+	timelineInfo.signalSemaphoreValueCount = 0;
+	timelineInfo.pSignalSemaphoreValues = nullptr;
+	timelineInfo.pNext = nullptr;
+
 	VkSubmitInfo submitInfo;
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = &imageAvailableSemaphores[currentFrame];
-
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	submitInfo.pWaitDstStageMask = waitStages;
+	submitInfo.waitSemaphoreCount = 2 - firstWait;
+	submitInfo.pWaitSemaphores = waitSemaphores + firstWait;
+	submitInfo.pWaitDstStageMask = waitStages + firstWait;
 
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &vulkanCommandList.commandBuffer;
 
-	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.signalSemaphoreCount = headless ? 0 : 1;
 	submitInfo.pSignalSemaphores = &renderFinishedSemaphores[currentFrame];
 
-	submitInfo.pNext = nullptr;
+	submitInfo.pNext = &timelineInfo;
 
 	vkQueueSubmit(device->GraphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]);
+	device->Counters().submits++;
+
+	frameCommands += vulkanCommandList.stats;
+	frameCommands += vulkanCommandList.executedStats;
 
 	inFlightResources.emplace(currentFrame, commandList);
 }
 
 RHICommandListRef VulkanRHI::CreateCommandList()
 {
-	VkCommandBuffer commandBuffer = createCommandBuffer(device->Device(), commandPool->CommandPool());
-	vkResetCommandBuffer(commandBuffer, 0);
+	auto& lists = commandLists[currentFrame];
+	size_t& used = usedCommandLists[currentFrame];
 
-	return RHICommandListRef(new VulkanCommandList(device, commandPool, commandBuffer, this));
+	if (used == lists.size()) {
+		VulkanCommandPoolRef& pool = commandPools[currentFrame];
+		VkCommandBuffer commandBuffer = createCommandBuffer(device->Device(), pool->CommandPool(), VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+		lists.emplace_back(new VulkanCommandList(device, pool, commandBuffer, this));
+	}
+
+	return lists[used++];
+}
+
+RHICommandListRef VulkanRHI::CreateSecondaryCommandList(const RHIRenderTargetRef& renderTarget)
+{
+	auto& lists = secondaryCommandLists[currentFrame];
+	size_t& used = usedSecondaryCommandLists[currentFrame];
+
+	// Every secondary list gets a pool of its own so that the threads recording them never share one.
+	if (used == lists.size()) {
+		VulkanCommandPoolRef pool = createCommandPool(device, device->GraphicsFamily());
+		VkCommandBuffer commandBuffer = createCommandBuffer(device->Device(), pool->CommandPool(), VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+		lists.emplace_back(new VulkanCommandList(device, pool, commandBuffer, this));
+	}
+
+	VulkanRenderTarget* vulkanRenderTarget = static_cast<VulkanRenderTarget*>(renderTarget.get());
+	VulkanRenderPassRef renderPass = createRenderPass(vulkanRenderTarget->imageIdx);
+
+	VulkanCommandListRef& commandList = lists[used++];
+	commandList->Inherit(renderPass->RenderPass(), createFramebuffer(renderPass, *vulkanRenderTarget));
+	return commandList;
 }
 
 VkExtent2D VulkanRHI::getExtent()
@@ -803,12 +1013,77 @@ VkExtent2D VulkanRHI::getExtent()
 	return extent;
 }
 
+// Device counters accumulated between two snapshots; commands are not included.
+RHIStats statsSince(const RHIStats& now, const RHIStats& start)
+{
+	return RHIStats{
+		.submits = now.submits - start.submits,
+		.fenceWaits = now.fenceWaits - start.fenceWaits,
+		.fenceWaitNs = now.fenceWaitNs - start.fenceWaitNs,
+		.descriptorSetsAllocated = now.descriptorSetsAllocated - start.descriptorSetsAllocated,
+		.memoryAllocations = now.memoryAllocations - start.memoryAllocations,
+		.memoryFrees = now.memoryFrees - start.memoryFrees,
+		.buffersCreated = now.buffersCreated - start.buffersCreated,
+		.buffersDestroyed = now.buffersDestroyed - start.buffersDestroyed,
+		.bufferBytesCreated = now.bufferBytesCreated - start.bufferBytesCreated,
+		.bufferBytesFreed = now.bufferBytesFreed - start.bufferBytesFreed,
+		.texturesCreated = now.texturesCreated - start.texturesCreated,
+		.texturesDestroyed = now.texturesDestroyed - start.texturesDestroyed,
+		.textureBytesCreated = now.textureBytesCreated - start.textureBytesCreated,
+		.textureBytesFreed = now.textureBytesFreed - start.textureBytesFreed,
+	};
+}
+
 RHIRenderTargetRef VulkanRHI::BeginFrame()
 {
+	totalCommands += frameCommands;
+	RHIStats totalStats = TotalStats();
+	lastFrameStats = statsSince(totalStats, frameStartStats);
+	lastFrameStats.commands = frameCommands;
+	frameStartStats = totalStats;
+	frameCommands = CommandListStats{};
+
+	auto waitBegin = std::chrono::steady_clock::now();
 	vkWaitForFences(device->Device(), 1, &inFlightFences[currentFrame], true, UINT64_MAX);
+	device->Counters().AddWait(waitBegin);
 	inFlightResources.erase(currentFrame);
+	uniformRings[currentFrame]->Reset();
+	vertexRings[currentFrame]->Reset();
+	indexRings[currentFrame]->Reset();
+	storageRings[currentFrame]->Reset();
+	uploadQueue->Collect();
+
+	// The fence wait above means this slot's queries are all written, so reading them does not stall.
+	if (timestampPools[currentFrame]) {
+		timestampPools[currentFrame]->Resolve(gpuTimings);
+	}
+
+	for (auto& commandList : commandLists[currentFrame]) {
+		commandList->Reset();
+	}
+	usedCommandLists[currentFrame] = 0;
+	vkResetCommandPool(device->Device(), commandPools[currentFrame]->CommandPool(), 0);
+
+	for (auto& commandList : secondaryCommandLists[currentFrame]) {
+		commandList->Reset();
+		vkResetCommandPool(device->Device(), commandList->commandPool->CommandPool(), 0);
+	}
+	usedSecondaryCommandLists[currentFrame] = 0;
+
+	descriptorCaches[currentFrame]->BeginFrame(++frameNumber);
+	if (bindlessTable) {
+		bindlessTable->BeginFrame(frameNumber);
+	}
+
 	vkResetFences(device->Device(), 1, &inFlightFences[currentFrame]);
 
+	if (headless) {
+		// Each frame slot owns its offscreen image, and the fence wait above means it is no longer in use.
+		currentSwapchainImgIdx = currentFrame;
+		return RHIRenderTargetRef(
+			new VulkanRenderTarget{ .swapchainImg = offscreenImages[currentFrame]->view, .imageIdx = currentSwapchainImgIdx });
+	}
+
 	vkAcquireNextImageKHR(device->Device(), swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], nullptr, &currentSwapchainImgIdx);
 
 	return RHIRenderTargetRef(
@@ -817,6 +1092,11 @@ RHIRenderTargetRef VulkanRHI::BeginFrame()
 
 void VulkanRHI::EndFrame()
 {
+	if (headless) {
+		currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+		return;
+	}
+
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 	presentInfo.swapchainCount = 1;
@@ -832,36 +1112,29 @@ void VulkanRHI::EndFrame()
 	currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
 
-RHIBufferRef VulkanRHI::CreateBuffer(size_t size, const BufferInfo& info)
+void VulkanRHI::ReadbackFrame(FrameImage& image)
 {
-	return RHIBufferRef(new VulkanBuffer(device, device->PhysicalDevice(), size, info));
-}
-
-VulkanDescriptorSetRef VulkanRHI::CreateDescriptorSet(const RHIGraphicsPipelineRef& pipeline, int num)
-{
-	VulkanGraphicsPipeline* vulkanPipeline = static_cast<VulkanGraphicsPipeline*>(pipeline.get());
-	VkDescriptorSetLayout layout = vulkanPipeline->DescriptorLayouts()[num];
-	return VulkanDescriptorSetRef(new VulkanDescriptorSet(device, descriptorPool, &layout));
-}
+	if (!headless) {
+		throw std::runtime_error("frame readback requires a headless driver");
+	}
+	if (frameNumber == 0) {
+		throw std::runtime_error("no frame to read back");
+	}
 
-RHITextureRef VulkanRHI::CreateTexture(uint32_t width, uint32_t height)
-{
-	return createImageImpl(device, device->PhysicalDevice(), width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
-}
+	// EndFrame has already moved on to the next slot.
+	uint32_t frame = (currentFrame + MAX_FRAMES_IN_FLIGHT - 1) % MAX_FRAMES_IN_FLIGHT;
+	uint32_t size = extent.width * extent.height * 4;
 
-void VulkanRHI::CopyBufferToTexture(const RHIBufferRef& buf, RHITextureRef& texture, uint32_t width, uint32_t height)
-{
-	VulkanBuffer* buffer = static_cast<VulkanBuffer*>(buf.get());
-	VulkanImage* image = static_cast<VulkanImage*>(texture.get());
-	transitionImageLayout(*this, image->image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	if (!readbackBuffer) {
+		readbackBuffer = std::make_shared<VulkanBuffer>(device, allocator, uploadQueue.get(), size,
+			BufferInfo{ .usage = BufferUsage::Readback });
+	}
 
 	auto cmdList = CreateCommandList();
+	VulkanCommandList& vulkanCommandList = static_cast<VulkanCommandList&>(*cmdList);
+	vulkanCommandList.Begin();
 
-	VulkanCommandList& vulkanCommmandList = static_cast<VulkanCommandList&>(*cmdList);
-	vulkanCommmandList.Begin();
-
-	VkBufferImageCopy region;
+	VkBufferImageCopy region{};
 	region.bufferOffset = 0;
 	region.bufferRowLength = 0;
 	region.bufferImageHeight = 0;
@@ -869,16 +1142,162 @@ void VulkanRHI::CopyBufferToTexture(const RHIBufferRef& buf, RHITextureRef& text
 	region.imageSubresource.mipLevel = 0;
 	region.imageSubresource.baseArrayLayer = 0;
 	region.imageSubresource.layerCount = 1;
-
 	region.imageOffset = { 0, 0, 0 };
-	region.imageExtent = { width, height, 1 };
+	region.imageExtent = { extent.width, extent.height, 1 };
 
-	vkCmdCopyBufferToImage(vulkanCommmandList.commandBuffer, buffer->Buffer(), image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+	vkCmdCopyImageToBuffer(vulkanCommandList.commandBuffer, offscreenImages[frame]->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		readbackBuffer->Buffer(), 1, &region);
 
-	vulkanCommmandList.End();
+	vulkanCommandList.End();
 	SubmitAndWaitIdle(cmdList);
 
-	transitionImageLayout(*this, image->image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	const uint8_t* pixels = (const uint8_t*)readbackBuffer->Mapped();
+	image.width = extent.width;
+	image.height = extent.height;
+	image.pixels.assign(pixels, pixels + size);
+}
+
+RHIBufferRef VulkanRHI::CreateBuffer(size_t size, const BufferInfo& info)
+{
+	return RHIBufferRef(new VulkanBuffer(device, allocator, uploadQueue.get(), size, info));
+}
+
+uint64_t VulkanRHI::FrameNumber()
+{
+	return frameNumber;
+}
+
+uint32_t VulkanRHI::FramesInFlight()
+{
+	return MAX_FRAMES_IN_FLIGHT;
+}
+
+VulkanDescriptorCache& VulkanRHI::DescriptorCache()
+{
+	return *descriptorCaches[currentFrame];
+}
+
+MemoryStats VulkanRHI::GetMemoryStats()
+{
+	return allocator->GetStats();
+}
+
+RHIStats VulkanRHI::FrameStats()
+{
+	return lastFrameStats;
+}
+
+RHIStats VulkanRHI::TotalStats()
+{
+	RHIStats stats;
+	device->Counters().Read(stats);
+	stats.commands = totalCommands;
+	stats.commands += frameCommands;
+	return stats;
+}
+
+const std::vector<GpuTiming>& VulkanRHI::GpuTimings()
+{
+	return gpuTimings;
+}
+
+VulkanTimestampPool* VulkanRHI::TimestampPool()
+{
+	return timestampPools[currentFrame].get();
+}
+
+const VulkanBindlessTableRef& VulkanRHI::BindlessTable() const
+{
+	return bindlessTable;
+}
+
+bool VulkanRHI::SupportsBindless()
+{
+	return bindlessTable != nullptr;
+}
+
+bool VulkanRHI::SupportsDrawIndirectCount()
+{
+	return device->SupportsDrawIndirectCount();
+}
+
+bool VulkanRHI::SupportsMultiDrawIndirect()
+{
+	return device->SupportsMultiDrawIndirect();
+}
+
+bool VulkanRHI::SupportsDrawIndirectFirstInstance()
+{
+	return device->SupportsDrawIndirectFirstInstance();
+}
+
+static VulkanBindlessTable& requireBindless(const VulkanBindlessTableRef& table)
+{
+	if (!table) {
+		throw std::runtime_error("bindless resources are not supported by this device");
+	}
+	return *table;
+}
+
+BindlessIndex VulkanRHI::RegisterBindlessTexture(const RHITextureRef& texture, const RHISamplerRef& sampler)
+{
+	return requireBindless(bindlessTable).AddTexture(texture, sampler);
+}
+
+BindlessIndex VulkanRHI::RegisterBindlessBuffer(const RHIBufferRef& buffer)
+{
+	return requireBindless(bindlessTable).AddBuffer(buffer);
+}
+
+void VulkanRHI::ReleaseBindlessTexture(BindlessIndex index)
+{
+	requireBindless(bindlessTable).RemoveTexture(index);
+}
+
+void VulkanRHI::ReleaseBindlessBuffer(BindlessIndex index)
+{
+	requireBindless(bindlessTable).RemoveBuffer(index);
+}
+
+VulkanRingAllocation VulkanRHI::AllocateUniform(uint32_t size)
+{
+	return uniformRings[currentFrame]->Allocate(size);
+}
+
+VulkanRingAllocation VulkanRHI::AllocateVertex(uint32_t size)
+{
+	return vertexRings[currentFrame]->Allocate(size);
+}
+
+VulkanRingAllocation VulkanRHI::AllocateIndex(uint32_t size)
+{
+	return indexRings[currentFrame]->Allocate(size);
+}
+
+VulkanRingAllocation VulkanRHI::AllocateStorage(uint32_t size)
+{
+	return storageRings[currentFrame]->Allocate(size);
+}
+
+RHITextureRef VulkanRHI::CreateTexture(uint32_t width, uint32_t height)
+{
+	return createImageImpl(device, allocator, width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+}
+
+RHITextureRef VulkanRHI::CreateStorageTexture(uint32_t width, uint32_t height)
+{
+	VulkanImageRef image = createImageImpl(device, allocator, width, height, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+	image->layout = VK_IMAGE_LAYOUT_GENERAL;
+
+	uploadQueue->InitializeStorageImage(image);
+	return image;
+}
+
+void VulkanRHI::CopyBufferToTexture(const RHIBufferRef& buf, RHITextureRef& texture, uint32_t width, uint32_t height)
+{
+	uploadQueue->CopyBufferToImage(buf, texture, width, height);
 }
 
 void VulkanRHI::SubmitAndWaitIdle(RHICommandListRef& commandList)
@@ -893,7 +1312,12 @@ void VulkanRHI::SubmitAndWaitIdle(RHICommandListRef& commandList)
 	submitInfo.pNext = nullptr;
 
 	vkQueueSubmit(device->GraphicsQueue(), 1, &submitInfo, nullptr);
+	device->Counters().submits++;
+	frameCommands += vulkanCommmandList.stats;
+
+	auto waitBegin = std::chrono::steady_clock::now();
 	vkDeviceWaitIdle(device->Device());
+	device->Counters().AddWait(waitBegin);
 }
 
 RHISamplerRef VulkanRHI::CreateSampler()
@@ -929,11 +1353,17 @@ RHISamplerRef VulkanRHI::CreateSampler()
 
 void VulkanRHI::WaitIdle()
 {
+	uploadQueue->Flush();
+
+	auto waitBegin = std::chrono::steady_clock::now();
 	vkDeviceWaitIdle(device->Device());
+	device->Counters().AddWait(waitBegin);
 }
 
 VulkanRHI::~VulkanRHI()
 {
+	pipelineCache->Save();
+
 	for (auto& p : frameBuffersCache) {
 		vkDestroyFramebuffer(device->Device(), p.second, nullptr);
 	}
@@ -944,11 +1374,14 @@ VulkanRHI::~VulkanRHI()
 		vkDestroyFence(device->Device(), inFlightFences[i], nullptr);
 	}
 
-	for (VkImageView view : swapchainImageViews) {
-		vkDestroyImageView(device->Device(), view, nullptr);
-	}
+	// Headless drivers enable neither VK_KHR_surface nor VK_KHR_swapchain.
+	if (!headless) {
+		for (VkImageView view : swapchainImageViews) {
+			vkDestroyImageView(device->Device(), view, nullptr);
+		}
 
-	vkDestroySwapchainKHR(device->Device(), swapchain, nullptr);
+		vkDestroySwapchainKHR(device->Device(), swapchain, nullptr);
 
-	vkDestroySurfaceKHR(instance->Instance(), surface, nullptr);
+		vkDestroySurfaceKHR(instance->Instance(), surface, nullptr);
+	}
 }
\ No newline at end of file
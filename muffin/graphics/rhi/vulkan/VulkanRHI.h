@@ -2,22 +2,31 @@
 
 #include "muffin/graphics/rhi/RHI.h"
 #include "Shared.h"
+#include "VulkanBuffer.h"
 #include "VulkanCommandList.h"
 #include "VulkanCommandPool.h"
 #include "VulkanDescriptorPool.h"
-#include "VulkanDescriptorSet.h"
+#include "VulkanBindlessTable.h"
+#include "VulkanDescriptorCache.h"
+#include "VulkanDescriptorLayoutCache.h"
 #include "VulkanDevice.h"
 #include "VulkanImage.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanPipelineCache.h"
 #include "VulkanRenderPass.h"
 #include "VulkanRenderTarget.h"
+#include "VulkanRingBuffer.h"
 #include "VulkanSampler.h"
 #include "VulkanShader.h"
+#include "VulkanTimestampPool.h"
+#include "VulkanUploadQueue.h"
 #include "VulkanWindow.h"
 
 #include <SDL2/SDL.h>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -26,11 +35,23 @@
 
 const int MAX_FRAMES_IN_FLIGHT = 2;
 
+const uint32_t UNIFORM_RING_PAGE_SIZE = 4 * 1024 * 1024;
+const uint32_t VERTEX_RING_PAGE_SIZE = 4 * 1024 * 1024;
+const uint32_t INDEX_RING_PAGE_SIZE = 1024 * 1024;
+const uint32_t STORAGE_RING_PAGE_SIZE = 16 * 1024 * 1024;
+
+// Relative to the working directory, like the shaders.
+const char* const PIPELINE_CACHE_FILE = "pipeline_cache.bin";
+
 class VulkanRHI : public RHIDriver
 {
 
 public:
-	VulkanRHI();
+	// Renders to the swapchain of a new window. validation enables the Khronos validation layer.
+	explicit VulkanRHI(bool validation);
+
+	// Headless: renders into offscreen images of the given size, without a window, surface or swapchain.
+	VulkanRHI(uint32_t width, uint32_t height, bool validation);
 
 	virtual ~VulkanRHI() override;
 
@@ -40,8 +61,12 @@ public:
 
 	virtual RHIGraphicsPipelineRef CreateGraphicsPipeline(const GraphicsPipelineCreateInfo& info) override;
 
+	virtual RHIComputePipelineRef CreateComputePipeline(const ComputePipelineCreateInfo& info) override;
+
 	virtual RHICommandListRef CreateCommandList() override;
 
+	virtual RHICommandListRef CreateSecondaryCommandList(const RHIRenderTargetRef& renderTarget) override;
+
 	virtual void Submit(RHICommandListRef& commandList) override;
 
 	virtual void WaitIdle() override;
@@ -50,29 +75,82 @@ public:
 
 	virtual RHIRenderTargetRef BeginFrame() override;
 
+	virtual uint64_t FrameNumber() override;
+
+	virtual uint32_t FramesInFlight() override;
+
 	virtual RHITextureRef CreateTexture(uint32_t width, uint32_t height) override;
 
+	virtual RHITextureRef CreateStorageTexture(uint32_t width, uint32_t height) override;
+
 	virtual RHISamplerRef CreateSampler() override;
 
 	virtual void CopyBufferToTexture(const RHIBufferRef& buf, RHITextureRef& texture, uint32_t width, uint32_t height) override;
 
 	virtual void EndFrame() override;
 
+	virtual void ReadbackFrame(FrameImage& image) override;
+
+	virtual MemoryStats GetMemoryStats() override;
+
+	virtual RHIStats FrameStats() override;
+
+	virtual RHIStats TotalStats() override;
+
+	virtual const std::vector<GpuTiming>& GpuTimings() override;
+
+	virtual bool SupportsBindless() override;
+
+	virtual bool SupportsDrawIndirectCount() override;
+
+	virtual bool SupportsMultiDrawIndirect() override;
+
+	virtual bool SupportsDrawIndirectFirstInstance() override;
+
+	virtual BindlessIndex RegisterBindlessTexture(const RHITextureRef& texture, const RHISamplerRef& sampler) override;
+
+	virtual BindlessIndex RegisterBindlessBuffer(const RHIBufferRef& buffer) override;
+
+	virtual void ReleaseBindlessTexture(BindlessIndex index) override;
+
+	virtual void ReleaseBindlessBuffer(BindlessIndex index) override;
+
 	VulkanRenderPassRef createRenderPass(int imgIdx);
 
 	VkFramebuffer createFramebuffer(VulkanRenderPassRef renderPass, const VulkanRenderTarget& renderTarget);
 
 	VkExtent2D getExtent();
 
-	VulkanDescriptorSetRef CreateDescriptorSet(const RHIGraphicsPipelineRef& pipeline, int num);
+	VulkanDescriptorCache& DescriptorCache();
+
+	// Null when the device lacks descriptor indexing.
+	const VulkanBindlessTableRef& BindlessTable() const;
+
+	// Queries of the frame being recorded; null when the device has no timestamp support.
+	VulkanTimestampPool* TimestampPool();
+
+	VulkanRingAllocation AllocateUniform(uint32_t size);
+
+	VulkanRingAllocation AllocateVertex(uint32_t size);
+
+	VulkanRingAllocation AllocateIndex(uint32_t size);
+
+	VulkanRingAllocation AllocateStorage(uint32_t size);
 
 	void waitIdle();
 
 private:
-	VulkanWindow window;
+	// Everything past the device and the swapchain (or offscreen images) that both modes share.
+	void createResources();
+
+	// Null when headless.
+	std::unique_ptr<VulkanWindow> window;
+	bool headless;
 
 	VulkanInstanceRef instance;
 	VulkanDeviceRef device;
+	VulkanMemoryAllocatorRef allocator;
+	VulkanUploadQueueRef uploadQueue;
 
 	VkSurfaceKHR surface;
 
@@ -83,19 +161,55 @@ private:
 	VkSwapchainKHR swapchain;
 	std::vector<VkImageView> swapchainImageViews;
 
-	VulkanCommandPoolRef commandPool;
+	// Headless mode renders into these in place of swapchain images, one per frame in flight, and leaves
+	// them in TRANSFER_SRC_OPTIMAL for ReadbackFrame.
+	VulkanImageRef offscreenImages[MAX_FRAMES_IN_FLIGHT];
+	std::shared_ptr<VulkanBuffer> readbackBuffer;
+
+	// Command lists live as long as their frame slot: the whole pool is reset in BeginFrame
+	// and the lists are handed out again from the start.
+	VulkanCommandPoolRef commandPools[MAX_FRAMES_IN_FLIGHT];
+	std::vector<VulkanCommandListRef> commandLists[MAX_FRAMES_IN_FLIGHT];
+	size_t usedCommandLists[MAX_FRAMES_IN_FLIGHT];
+
+	std::vector<VulkanCommandListRef> secondaryCommandLists[MAX_FRAMES_IN_FLIGHT];
+	size_t usedSecondaryCommandLists[MAX_FRAMES_IN_FLIGHT];
 
-	VulkanDescriptorPoolRef descriptorPool;
+	VulkanDescriptorCacheRef descriptorCaches[MAX_FRAMES_IN_FLIGHT];
+	VulkanDescriptorLayoutCacheRef descriptorLayoutCache;
+	VulkanBindlessTableRef bindlessTable;
+
+	VulkanPipelineCacheRef pipelineCache;
+	// Pipelines handed out, by create info, so that equal requests share one while it is alive. Entries of
+	// released pipelines, and the shader references in their keys, are dropped on the next creation.
+	std::map<GraphicsPipelineCreateInfo, std::weak_ptr<RHIGraphicsPipeline>> graphicsPipelines;
+	std::map<ComputePipelineCreateInfo, std::weak_ptr<RHIComputePipeline>> computePipelines;
 
 	VkSemaphore imageAvailableSemaphores[MAX_FRAMES_IN_FLIGHT];
 	VkSemaphore renderFinishedSemaphores[MAX_FRAMES_IN_FLIGHT];
 	VkFence inFlightFences[MAX_FRAMES_IN_FLIGHT];
 
+	VulkanRingBufferRef uniformRings[MAX_FRAMES_IN_FLIGHT];
+	VulkanRingBufferRef vertexRings[MAX_FRAMES_IN_FLIGHT];
+	VulkanRingBufferRef indexRings[MAX_FRAMES_IN_FLIGHT];
+	VulkanRingBufferRef storageRings[MAX_FRAMES_IN_FLIGHT];
+
+	VulkanTimestampPoolRef timestampPools[MAX_FRAMES_IN_FLIGHT];
+	std::vector<GpuTiming> gpuTimings;
+
+	// Commands submitted since the last BeginFrame and since creation; the other counters live in the device.
+	CommandListStats frameCommands;
+	CommandListStats totalCommands;
+	// Totals as of the last BeginFrame, which the next one subtracts to get the frame's counters.
+	RHIStats frameStartStats;
+	RHIStats lastFrameStats;
+
 	std::unordered_map<int, VkFramebuffer> frameBuffersCache;
 	std::unordered_map<int, VulkanRenderPassRef> renderPassCache;
 
 	uint32_t currentSwapchainImgIdx;
 	uint32_t currentFrame;
+	std::atomic<uint64_t> frameNumber;
 
 	VulkanImageRef depthImage;
 
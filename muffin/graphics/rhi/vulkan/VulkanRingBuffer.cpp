@@ -0,0 +1,41 @@
+#include "VulkanRingBuffer.h"
+
+#include <stdexcept>
+
+VulkanRingBuffer::VulkanRingBuffer(VulkanDeviceRef device, VulkanMemoryAllocatorRef allocator, uint32_t pageSize,
+	uint32_t alignment, const BufferInfo& info)
+	: device(device), allocator(allocator), pageSize(pageSize), alignment(alignment), info(info), currentPage(0), head(0)
+{
+	pages.emplace_back(new VulkanBuffer(device, allocator, nullptr, pageSize, info));
+}
+
+VulkanRingAllocation VulkanRingBuffer::Allocate(uint32_t size)
+{
+	if (size > pageSize) {
+		throw std::runtime_error("ring buffer allocation exceeds page size");
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	uint32_t offset = (head + alignment - 1) & ~(alignment - 1);
+
+	if (offset + size > pageSize) {
+		currentPage++;
+		if (currentPage == pages.size()) {
+			pages.emplace_back(new VulkanBuffer(device, allocator, nullptr, pageSize, info));
+		}
+		offset = 0;
+	}
+
+	head = offset + size;
+
+	VulkanBuffer* page = pages[currentPage].get();
+	return VulkanRingAllocation{ .buffer = page, .offset = offset, .data = (char*)page->Mapped() + offset };
+}
+
+void VulkanRingBuffer::Reset()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	currentPage = 0;
+	head = 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct VulkanRingAllocation
+{
+	VulkanBuffer* buffer;
+	uint32_t offset;
+	void* data;
+};
+
+// Persistently mapped linear allocator for data that lives for a single frame.
+// Allocations are never freed individually: the whole ring is rewound by Reset()
+// once the GPU is done with the frame that owns it. Allocate() may be called from any thread.
+class VulkanRingBuffer
+{
+public:
+	VulkanRingBuffer(VulkanDeviceRef device, VulkanMemoryAllocatorRef allocator, uint32_t pageSize, uint32_t alignment, const BufferInfo& info);
+
+	VulkanRingAllocation Allocate(uint32_t size);
+
+	void Reset();
+
+private:
+	VulkanDeviceRef device;
+	VulkanMemoryAllocatorRef allocator;
+	uint32_t pageSize;
+	uint32_t alignment;
+	BufferInfo info;
+
+	std::mutex mutex;
+	std::vector<std::unique_ptr<VulkanBuffer>> pages;
+	size_t currentPage;
+	uint32_t head;
+};
+
+using VulkanRingBufferRef = std::shared_ptr<VulkanRingBuffer>;
@@ -22,6 +22,11 @@ struct VulkanShader : public RHIShader
 	std::map<int, std::vector<VkDescriptorSetLayoutBinding>> bindings;
 	std::vector<VkVertexInputAttributeDescription> vertexAttributes;
 	std::vector<VkVertexInputBindingDescription> vertexBindings;
+	// At most one block per stage.
+	std::vector<VkPushConstantRange> pushConstantRanges;
+
+	// Set declaring runtime-sized resource arrays, served by the bindless table; -1 if none.
+	int bindlessSet = -1;
 
 	std::unordered_map<std::string, DescriptorSetBindingPoint> params;
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "VulkanTimestampPool.h"
+
+VulkanTimestampPool::VulkanTimestampPool(VulkanDeviceRef device, uint32_t regionCapacity)
+	: device(device), capacity(regionCapacity)
+{
+	VkQueryPoolCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	createInfo.queryCount = capacity * 2;
+	createInfo.flags = 0;
+	createInfo.pNext = nullptr;
+
+	vkCreateQueryPool(device->Device(), &createInfo, nullptr, &queryPool);
+	vkResetQueryPool(device->Device(), queryPool, 0, capacity * 2);
+}
+
+VulkanTimestampPool::~VulkanTimestampPool()
+{
+	vkDestroyQueryPool(device->Device(), queryPool, nullptr);
+}
+
+uint32_t VulkanTimestampPool::BeginRegion(VkCommandBuffer commandBuffer, const char* name)
+{
+	uint32_t region;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (names.size() == capacity) {
+			return NO_REGION;
+		}
+		region = names.size();
+		names.push_back(name);
+	}
+
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, region * 2);
+	return region;
+}
+
+void VulkanTimestampPool::EndRegion(VkCommandBuffer commandBuffer, uint32_t region)
+{
+	if (region != NO_REGION) {
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, region * 2 + 1);
+	}
+}
+
+void VulkanTimestampPool::Resolve(std::vector<GpuTiming>& timings)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	timings.clear();
+	if (names.empty()) {
+		return;
+	}
+
+	// Value and availability of every query; with availability requested nothing waits.
+	std::vector<uint64_t> results(names.size() * 4);
+	vkGetQueryPoolResults(device->Device(), queryPool, 0, names.size() * 2, results.size() * sizeof(uint64_t), results.data(),
+		2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+	double period = device->TimestampPeriod();
+	for (size_t i = 0; i < names.size(); i++) {
+		const uint64_t* begin = &results[i * 4];
+		const uint64_t* end = &results[i * 4 + 2];
+		if (!begin[1] || !end[1]) {
+			continue;
+		}
+		timings.push_back(GpuTiming{
+			.name = names[i],
+			.begin = uint64_t(begin[0] * period),
+			.end = uint64_t(end[0] * period),
+		});
+	}
+
+	vkResetQueryPool(device->Device(), queryPool, 0, names.size() * 2);
+	names.clear();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "muffin/graphics/rhi/RHI.h"
+#include "VulkanDevice.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+const uint32_t TIMESTAMP_REGIONS_PER_FRAME = 256;
+
+// Timestamp queries of one frame in flight, two per region. Regions are opened by the command lists
+// recording the frame, from any thread, and read back by Resolve once the frame's fence has signaled.
+class VulkanTimestampPool
+{
+public:
+	static const uint32_t NO_REGION = UINT32_MAX;
+
+	VulkanTimestampPool(VulkanDeviceRef device, uint32_t regionCapacity);
+
+	~VulkanTimestampPool();
+
+	// Writes the begin timestamp; returns NO_REGION once the pool is full.
+	uint32_t BeginRegion(VkCommandBuffer commandBuffer, const char* name);
+
+	void EndRegion(VkCommandBuffer commandBuffer, uint32_t region);
+
+	// Replaces timings with the finished frame's regions, then resets the pool. Regions that were never
+	// submitted or ended are dropped.
+	void Resolve(std::vector<GpuTiming>& timings);
+
+private:
+	VulkanDeviceRef device;
+	VkQueryPool queryPool;
+	uint32_t capacity;
+
+	std::mutex mutex;
+	std::vector<const char*> names;
+};
+
+using VulkanTimestampPoolRef = std::shared_ptr<VulkanTimestampPool>;
@@ -0,0 +1,263 @@
+#include "VulkanUploadQueue.h"
+#include "Shared.h"
+
+#include <chrono>
+#include <cstring>
+
+VulkanUploadQueue::VulkanUploadQueue(VulkanDeviceRef device, VulkanMemoryAllocatorRef allocator, VkQueue queue,
+	uint32_t queueFamily)
+	: device(device), allocator(allocator), queue(queue), recording(VK_NULL_HANDLE), submittedValue(0)
+{
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = queueFamily;
+	poolInfo.pNext = nullptr;
+
+	VULKAN_RHI_SAFE_CALL(vkCreateCommandPool(device->Device(), &poolInfo, nullptr, &commandPool));
+
+	VkSemaphoreTypeCreateInfo typeInfo{};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeInfo.initialValue = 0;
+	typeInfo.pNext = nullptr;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.flags = 0;
+	semaphoreInfo.pNext = &typeInfo;
+
+	VULKAN_RHI_SAFE_CALL(vkCreateSemaphore(device->Device(), &semaphoreInfo, nullptr, &timeline));
+}
+
+VulkanUploadQueue::~VulkanUploadQueue()
+{
+	Wait(Flush());
+	Collect();
+
+	vkDestroySemaphore(device->Device(), timeline, nullptr);
+	vkDestroyCommandPool(device->Device(), commandPool, nullptr);
+}
+
+VkCommandBuffer VulkanUploadQueue::recordingCommandBuffer()
+{
+	if (recording) {
+		return recording;
+	}
+
+	if (freeCommandBuffers.empty()) {
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = commandPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount = 1;
+		allocInfo.pNext = nullptr;
+
+		VULKAN_RHI_SAFE_CALL(vkAllocateCommandBuffers(device->Device(), &allocInfo, &recording));
+	} else {
+		recording = freeCommandBuffers.back();
+		freeCommandBuffers.pop_back();
+		vkResetCommandBuffer(recording, 0);
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	beginInfo.pInheritanceInfo = nullptr;
+	beginInfo.pNext = nullptr;
+
+	vkBeginCommandBuffer(recording, &beginInfo);
+
+	// Destination resources may still be read by frames submitted earlier on the same queue.
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.pNext = nullptr;
+
+	vkCmdPipelineBarrier(recording, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0,
+		nullptr, 0, nullptr);
+
+	return recording;
+}
+
+void VulkanUploadQueue::UploadBuffer(const RHIBufferRef& dst, VkDeviceSize offset, const void* data, VkDeviceSize size)
+{
+	auto staging = std::make_shared<VulkanBuffer>(device, allocator, nullptr, size, BufferInfo{ BufferUsage::Staging });
+	memcpy(staging->Mapped(), data, size);
+
+	VkBufferCopy region{};
+	region.srcOffset = 0;
+	region.dstOffset = offset;
+	region.size = size;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	VkCommandBuffer commandBuffer = recordingCommandBuffer();
+	vkCmdCopyBuffer(commandBuffer, staging->Buffer(), static_cast<VulkanBuffer*>(dst.get())->Buffer(), 1, &region);
+
+	pendingResources.push_back(staging);
+	pendingResources.push_back(dst);
+}
+
+void VulkanUploadQueue::CopyBufferToImage(const RHIBufferRef& src, const RHITextureRef& dst, uint32_t width,
+	uint32_t height)
+{
+	VulkanBuffer* buffer = static_cast<VulkanBuffer*>(src.get());
+	VulkanImage* image = static_cast<VulkanImage*>(dst.get());
+
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image->image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.srcAccessMask = VK_ACCESS_NONE;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.pNext = nullptr;
+
+	VkBufferImageCopy region{};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { width, height, 1 };
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	VkCommandBuffer commandBuffer = recordingCommandBuffer();
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+		nullptr, 1, &barrier);
+
+	vkCmdCopyBufferToImage(commandBuffer, buffer->Buffer(), image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr,
+		0, nullptr, 1, &barrier);
+
+	pendingResources.push_back(src);
+	pendingResources.push_back(dst);
+}
+
+void VulkanUploadQueue::InitializeStorageImage(const RHITextureRef& texture)
+{
+	VulkanImage* image = static_cast<VulkanImage*>(texture.get());
+
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image->image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.srcAccessMask = VK_ACCESS_NONE;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.pNext = nullptr;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	VkCommandBuffer commandBuffer = recordingCommandBuffer();
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr,
+		0, nullptr, 1, &barrier);
+
+	pendingResources.push_back(texture);
+}
+
+uint64_t VulkanUploadQueue::Flush()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (!recording) {
+		return submittedValue;
+	}
+
+	vkEndCommandBuffer(recording);
+
+	uint64_t signalValue = submittedValue + 1;
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = 0;
+	timelineInfo.pWaitSemaphoreValues = nullptr;
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &signalValue;
+	timelineInfo.pNext = nullptr;
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &recording;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &timeline;
+	submitInfo.waitSemaphoreCount = 0;
+	submitInfo.pNext = &timelineInfo;
+
+	VULKAN_RHI_SAFE_CALL(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE));
+	device->Counters().submits++;
+
+	submittedValue = signalValue;
+	inFlight.push_back(Batch{ .commandBuffer = recording, .value = signalValue, .resources = std::move(pendingResources) });
+
+	recording = VK_NULL_HANDLE;
+	pendingResources.clear();
+
+	return submittedValue;
+}
+
+void VulkanUploadQueue::Collect()
+{
+	uint64_t completed = 0;
+	vkGetSemaphoreCounterValue(device->Device(), timeline, &completed);
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	while (!inFlight.empty() && inFlight.front().value <= completed) {
+		freeCommandBuffers.push_back(inFlight.front().commandBuffer);
+		inFlight.pop_front();
+	}
+}
+
+void VulkanUploadQueue::Wait(uint64_t value)
+{
+	if (value == 0) {
+		return;
+	}
+
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.flags = 0;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &timeline;
+	waitInfo.pValues = &value;
+	waitInfo.pNext = nullptr;
+
+	auto waitBegin = std::chrono::steady_clock::now();
+	vkWaitSemaphores(device->Device(), &waitInfo, UINT64_MAX);
+	device->Counters().AddWait(waitBegin);
+}
+
+VkSemaphore VulkanUploadQueue::Semaphore() const
+{
+	return timeline;
+}
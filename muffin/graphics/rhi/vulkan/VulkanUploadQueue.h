@@ -0,0 +1,67 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "VulkanDevice.h"
+#include "VulkanImage.h"
+#include "VulkanMemoryAllocator.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Records staging copies into a single command buffer that is submitted once per frame.
+// Completion is tracked with a timeline semaphore: every submitted batch signals the next
+// value, and frame submissions wait for the last one before reading uploaded data.
+class VulkanUploadQueue
+{
+public:
+	VulkanUploadQueue(VulkanDeviceRef device, VulkanMemoryAllocatorRef allocator, VkQueue queue, uint32_t queueFamily);
+
+	~VulkanUploadQueue();
+
+	void UploadBuffer(const RHIBufferRef& dst, VkDeviceSize offset, const void* data, VkDeviceSize size);
+
+	void CopyBufferToImage(const RHIBufferRef& src, const RHITextureRef& dst, uint32_t width, uint32_t height);
+
+	// Moves a new storage texture into VK_IMAGE_LAYOUT_GENERAL, where it stays.
+	void InitializeStorageImage(const RHITextureRef& texture);
+
+	uint64_t Flush();
+
+	void Collect();
+
+	void Wait(uint64_t value);
+
+	VkSemaphore Semaphore() const;
+
+private:
+	struct Batch
+	{
+		VkCommandBuffer commandBuffer;
+		uint64_t value;
+		std::vector<RHIResourceRef> resources;
+	};
+
+	VkCommandBuffer recordingCommandBuffer();
+
+	VulkanDeviceRef device;
+	VulkanMemoryAllocatorRef allocator;
+	VkQueue queue;
+
+	VkCommandPool commandPool;
+	VkSemaphore timeline;
+
+	VkCommandBuffer recording;
+	std::vector<RHIResourceRef> pendingResources;
+
+	std::deque<Batch> inFlight;
+	std::vector<VkCommandBuffer> freeCommandBuffers;
+
+	uint64_t submittedValue;
+
+	std::mutex mutex;
+};
+
+using VulkanUploadQueueRef = std::shared_ptr<VulkanUploadQueue>;
@@ -1,9 +1,9 @@
 #version 450
 
-layout (set = 0, binding = 0) uniform UniformBufferObject {
+layout (push_constant) uniform PushConstants {
 	vec2 scale;
 	vec2 translate;
-} ubo;
+} pc;
 
 layout (location = 0) in vec2 inPos;
 layout (location = 1) in vec2 inUV;
@@ -16,5 +16,5 @@ void main()
 {
 	outUV = inUV;
 	outColor = inColor;
-	gl_Position = vec4(inPos * ubo.scale + ubo.translate, 0.0, 1.0);
+	gl_Position = vec4(inPos * pc.scale + pc.translate, 0.0, 1.0);
 }
\ No newline at end of file
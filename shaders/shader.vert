@@ -1,21 +1,23 @@
 #version 450
 
-layout (set=0, binding = 0) uniform UniformBufferObject {
-    mat4 model;
+layout (set=0, binding = 0) uniform ViewUniforms {
     mat4 view;
     mat4 proj;
-} ubo;
+    mat4 viewProj;
+    vec4 position;
+} camera;
 
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec3 inColor;
 layout (location = 2) in vec2 inTexCoord;
+layout (location = 3) in mat4 instanceModel;
 
 layout (location = 0) out vec3 fragColor;
 layout (location = 1) out vec2 fragTexCoord;
 
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    gl_Position = camera.viewProj * instanceModel * vec4(inPosition, 1.0);
     fragColor = inColor;
     fragTexCoord = inTexCoord;
 }
\ No newline at end of file
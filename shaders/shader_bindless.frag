@@ -0,0 +1,17 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (location = 0) in vec3 fragColor;
+layout (location = 1) in vec2 fragTexCoord;
+
+layout (location = 0) out vec4 outColor;
+
+layout (set = 1, binding = 0) uniform sampler2D textures[];
+
+layout (push_constant) uniform MaterialConstants {
+    uint textureIndex;
+} material;
+
+void main() {
+    outColor = texture(textures[material.textureIndex], fragTexCoord);
+}
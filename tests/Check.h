@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdio>
+
+// Failed checks are reported and counted rather than aborting, so one run lists every broken invariant.
+inline int checkFailures = 0;
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			checkFailures++; \
+		} \
+	} while (0)
@@ -0,0 +1,125 @@
+#include "Check.h"
+#include "muffin/graphics/rhi/vulkan/VulkanMemoryAllocator.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+// Drives the buddy free lists of one block through random allocations and frees, checking alignment,
+// overlap and byte accounting after every step, and that freeing everything merges back to one range.
+
+static const size_t STEPS = 20000;
+
+struct Range
+{
+	VkDeviceSize offset;
+	uint32_t order;
+};
+
+static VkDeviceSize rangeSize(uint32_t order)
+{
+	return MIN_SUBALLOCATION_SIZE << order;
+}
+
+static VkDeviceSize freeBytes(const VulkanMemoryBlock& block)
+{
+	VkDeviceSize bytes = 0;
+	for (uint32_t order = 0; order < block.freeLists.size(); order++) {
+		bytes += block.freeLists[order].size() * rangeSize(order);
+	}
+	return bytes;
+}
+
+static bool isFullyMerged(const VulkanMemoryBlock& block)
+{
+	for (uint32_t order = 0; order + 1 < block.freeLists.size(); order++) {
+		if (!block.freeLists[order].empty()) {
+			return false;
+		}
+	}
+	return block.freeLists.back().size() == 1 && *block.freeLists.back().begin() == 0;
+}
+
+static void testSplit()
+{
+	VulkanMemoryBlock block{ .size = MEMORY_BLOCK_SIZE, .dedicated = false, .allocatedBytes = 0 };
+	BuddyInit(block);
+	CHECK(rangeSize(block.freeLists.size() - 1) == MEMORY_BLOCK_SIZE);
+
+	// Taking the smallest range splits the block once per order, leaving one free buddy on each level.
+	VkDeviceSize offset = 1;
+	CHECK(BuddyTake(block, 0, offset));
+	CHECK(offset == 0);
+	for (uint32_t order = 0; order + 1 < block.freeLists.size(); order++) {
+		CHECK(block.freeLists[order].size() == 1);
+		CHECK(block.freeLists[order].count(rangeSize(order)) == 1);
+	}
+	CHECK(block.freeLists.back().empty());
+
+	BuddyRelease(block, 0, offset);
+	CHECK(isFullyMerged(block));
+}
+
+static void testRandom()
+{
+	VulkanMemoryBlock block{ .size = MEMORY_BLOCK_SIZE, .dedicated = false, .allocatedBytes = 0 };
+	BuddyInit(block);
+
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<VkDeviceSize> size(1, 1024 * 1024);
+	std::uniform_int_distribution<uint32_t> alignmentShift(0, 16);
+	std::uniform_int_distribution<int> action(0, 2);
+
+	std::vector<Range> live;
+	std::map<VkDeviceSize, VkDeviceSize> used;
+	VkDeviceSize allocated = 0;
+
+	for (size_t step = 0; step < STEPS; step++) {
+		if (live.empty() || action(rng) != 0) {
+			VkDeviceSize alignment = VkDeviceSize(1) << alignmentShift(rng);
+			uint32_t order = BuddyOrderForSize(std::max(size(rng), alignment));
+
+			VkDeviceSize offset;
+			if (!BuddyTake(block, order, offset)) {
+				continue;
+			}
+
+			CHECK(offset % alignment == 0);
+			CHECK(offset % rangeSize(order) == 0);
+			CHECK(offset + rangeSize(order) <= block.size);
+
+			auto next = used.lower_bound(offset);
+			CHECK(next == used.end() || offset + rangeSize(order) <= next->first);
+			CHECK(next == used.begin() || std::prev(next)->second <= offset);
+
+			used[offset] = offset + rangeSize(order);
+			live.push_back({ offset, order });
+			allocated += rangeSize(order);
+		} else {
+			size_t i = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+			BuddyRelease(block, live[i].order, live[i].offset);
+			used.erase(live[i].offset);
+			allocated -= rangeSize(live[i].order);
+			live[i] = live.back();
+			live.pop_back();
+		}
+
+		CHECK(freeBytes(block) + allocated == block.size);
+	}
+
+	std::shuffle(live.begin(), live.end(), rng);
+	for (const Range& range : live) {
+		BuddyRelease(block, range.order, range.offset);
+	}
+	CHECK(isFullyMerged(block));
+}
+
+int main()
+{
+	testSplit();
+	testRandom();
+
+	std::printf("allocator_test: %d failed checks\n", checkFailures);
+	return checkFailures ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+#include "Check.h"
+#include "muffin/graphics/DynamicBVH.h"
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// Random insert, move and remove churn on a DynamicBVH. After every batch the tree must validate, hold
+// exactly the live proxies, keep every object inside its fat leaf and stay logarithmically deep.
+
+static const size_t OBJECT_COUNT = 2000;
+static const size_t ROUNDS = 50;
+
+struct Object
+{
+	int32_t proxy;
+	uint32_t id;
+	AABB box;
+};
+
+static AABB randomBox(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> position(-100.f, 100.f);
+	std::uniform_real_distribution<float> extent(0.1f, 2.f);
+	glm::vec3 center(position(rng), position(rng), position(rng));
+	glm::vec3 half(extent(rng), extent(rng), extent(rng));
+	return AABB{ .min = center - half, .max = center + half };
+}
+
+static void checkTree(const DynamicBVH& bvh, const std::vector<Object>& objects)
+{
+	size_t leaves = 0;
+	try {
+		leaves = bvh.Validate();
+	} catch (const std::runtime_error& e) {
+		std::printf("bvh validation failed: %s\n", e.what());
+		checkFailures++;
+		return;
+	}
+	CHECK(leaves == objects.size());
+
+	for (size_t i = 0; i < objects.size(); i++) {
+		CHECK(bvh.UserData(objects[i].proxy) == objects[i].id);
+		CHECK(bvh.FatBounds(objects[i].proxy).Contains(objects[i].box));
+	}
+
+	// Rotations keep the tree close to balanced; allow up to twice the height of a perfect tree.
+	if (!objects.empty()) {
+		CHECK(bvh.Height() <= 2 * std::ceil(std::log2(float(objects.size()))) + 1);
+	}
+}
+
+int main()
+{
+	DynamicBVH bvh;
+	std::vector<Object> objects;
+	std::mt19937 rng(11);
+	uint32_t nextId = 0;
+
+	auto insert = [&]() {
+		AABB box = randomBox(rng);
+		objects.push_back({ bvh.Insert(box, nextId), nextId, box });
+		nextId++;
+	};
+
+	for (size_t i = 0; i < OBJECT_COUNT; i++) {
+		insert();
+	}
+	checkTree(bvh, objects);
+
+	std::uniform_real_distribution<float> jitter(-0.05f, 0.05f);
+	std::uniform_int_distribution<int> action(0, 9);
+
+	for (size_t round = 0; round < ROUNDS; round++) {
+		for (Object& object : objects) {
+			int a = action(rng);
+			if (a < 6) {
+				// Small moves mostly stay inside the fat bounds; the rest teleport and must reinsert.
+				glm::vec3 delta(jitter(rng), jitter(rng), jitter(rng));
+				object.box = AABB{ .min = object.box.min + delta, .max = object.box.max + delta };
+				bvh.Move(object.proxy, object.box);
+			} else if (a < 8) {
+				object.box = randomBox(rng);
+				CHECK(bvh.Move(object.proxy, object.box));
+			}
+		}
+
+		// Remove a tenth of the objects, then refill, so freed nodes get reused.
+		for (size_t n = 0; n < OBJECT_COUNT / 10; n++) {
+			size_t i = std::uniform_int_distribution<size_t>(0, objects.size() - 1)(rng);
+			bvh.Remove(objects[i].proxy);
+			objects[i] = objects.back();
+			objects.pop_back();
+		}
+		checkTree(bvh, objects);
+
+		while (objects.size() < OBJECT_COUNT) {
+			insert();
+		}
+		checkTree(bvh, objects);
+	}
+
+	std::printf("bvh_test: %d failed checks\n", checkFailures);
+	return checkFailures ? 1 : 0;
+}
@@ -0,0 +1,97 @@
+#include "Check.h"
+#include "muffin/graphics/RenderQueue.h"
+
+#include <random>
+#include <set>
+#include <vector>
+
+// Sorts a shuffled mix of opaque, transparent and overlay renderables and checks the order each bucket
+// promises: opaque grouped by state and front to back, transparent back to front, overlay as submitted.
+
+static const size_t COUNT = 3000;
+
+struct TestRenderable : Renderable
+{
+	SortInfo info;
+	uint32_t submission;
+
+	TestRenderable(const SortInfo& info, uint32_t submission)
+		: info(info), submission(submission)
+	{
+	}
+
+	void Render(RHICommandListRef commandList) override {}
+
+	SortInfo GetSortInfo() override { return info; }
+};
+
+static float distance2(const SortInfo& info)
+{
+	return glm::dot(info.position, info.position);
+}
+
+int main()
+{
+	// Only the addresses matter for sorting.
+	char pipelines[3];
+	char materials[4];
+	char meshes[5];
+
+	std::mt19937 rng(5);
+	std::uniform_int_distribution<int> bucket(0, 2);
+	std::uniform_int_distribution<int> distance(1, 1000);
+
+	RenderQueue queue;
+	for (uint32_t i = 0; i < COUNT; i++) {
+		SortInfo info;
+		info.bucket = RenderBucket(bucket(rng));
+		info.pipeline = &pipelines[rng() % 3];
+		info.material = &materials[rng() % 4];
+		info.mesh = &meshes[rng() % 5];
+		info.position = glm::vec3(float(distance(rng)), 0.f, 0.f);
+		queue.Push(std::make_shared<TestRenderable>(info, i));
+	}
+
+	JobSystem jobs(0);
+	queue.Sort(glm::vec3(0.f), jobs);
+	CHECK(queue.Size() == COUNT);
+
+	std::set<const void*> finishedPipelines;
+	std::set<const TestRenderable*> seen;
+
+	for (size_t i = 0; i < queue.Size(); i++) {
+		const SortInfo& info = queue.Info(i);
+		const TestRenderable* renderable = static_cast<const TestRenderable*>(queue[i].get());
+		CHECK(seen.insert(renderable).second);
+		CHECK(info.bucket == renderable->info.bucket && info.position == renderable->info.position);
+
+		if (i == 0) {
+			continue;
+		}
+		const SortInfo& previous = queue.Info(i - 1);
+		const TestRenderable* previousRenderable = static_cast<const TestRenderable*>(queue[i - 1].get());
+
+		CHECK(previous.bucket <= info.bucket);
+		if (previous.bucket != info.bucket) {
+			continue;
+		}
+
+		if (info.bucket == RenderBucket::Opaque) {
+			// A pipeline's draws are contiguous, and identical state is drawn front to back.
+			if (previous.pipeline != info.pipeline) {
+				finishedPipelines.insert(previous.pipeline);
+				CHECK(!finishedPipelines.count(info.pipeline));
+			}
+			if (previous.pipeline == info.pipeline && previous.material == info.material && previous.mesh == info.mesh) {
+				CHECK(distance2(previous) <= distance2(info));
+			}
+		} else if (info.bucket == RenderBucket::Transparent) {
+			CHECK(distance2(previous) >= distance2(info));
+		} else {
+			CHECK(previousRenderable->submission < renderable->submission);
+		}
+	}
+
+	std::printf("render_queue_test: %d failed checks\n", checkFailures);
+	return checkFailures ? 1 : 0;
+}
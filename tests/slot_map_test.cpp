@@ -0,0 +1,75 @@
+#include "Check.h"
+#include "muffin/core/SlotMap.h"
+
+#include <random>
+#include <vector>
+
+// Handles must stop resolving once their element is removed, even after the slot is reused, while
+// every live handle keeps resolving to its own value through the swaps Remove does in the dense array.
+
+static const size_t STEPS = 20000;
+
+struct Entry
+{
+	SlotHandle handle;
+	int value;
+};
+
+int main()
+{
+	SlotMap<int> map;
+
+	SlotHandle first = map.Insert(1);
+	CHECK(map.Remove(first));
+	CHECK(!map.Contains(first));
+	CHECK(map.Get(first) == nullptr);
+	CHECK(!map.Remove(first));
+
+	// The freed slot is reused with a new generation, so the old handle must not see the new value.
+	SlotHandle second = map.Insert(2);
+	CHECK(second.index == first.index);
+	CHECK(second.generation != first.generation);
+	CHECK(map.Get(first) == nullptr);
+	CHECK(map.Get(second) && *map.Get(second) == 2);
+
+	CHECK(!map.Contains(SlotHandle{}));
+	CHECK(!map.Contains(SlotHandle{ .index = second.index + 1, .generation = 0 }));
+	CHECK(map.Remove(second));
+
+	std::mt19937 rng(3);
+	std::uniform_int_distribution<int> action(0, 2);
+	std::vector<Entry> live;
+	std::vector<SlotHandle> stale;
+
+	for (size_t step = 0; step < STEPS; step++) {
+		if (live.empty() || action(rng) != 0) {
+			int value = int(step);
+			live.push_back({ map.Insert(value), value });
+		} else {
+			size_t i = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+			CHECK(map.Remove(live[i].handle));
+			stale.push_back(live[i].handle);
+			live[i] = live.back();
+			live.pop_back();
+		}
+	}
+
+	CHECK(map.Size() == live.size());
+	for (const Entry& entry : live) {
+		const int* value = map.Get(entry.handle);
+		CHECK(value && *value == entry.value);
+	}
+	for (SlotHandle handle : stale) {
+		CHECK(!map.Contains(handle));
+		CHECK(!map.Remove(handle));
+	}
+
+	// Dense iteration and HandleAt agree with the handles handed out.
+	for (size_t i = 0; i < map.Size(); i++) {
+		SlotHandle handle = map.HandleAt(i);
+		CHECK(map.Get(handle) == &map.Values()[i]);
+	}
+
+	std::printf("slot_map_test: %d failed checks\n", checkFailures);
+	return checkFailures ? 1 : 0;
+}
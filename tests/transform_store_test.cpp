@@ -0,0 +1,211 @@
+#include "Check.h"
+#include "muffin/graphics/TransformStore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+// Checks World == parent World * Local after reparenting, destroying parents and editing parents and children
+// in the same frame, and that Update() returns every transform it recomputed exactly once.
+
+static const size_t TRANSFORM_COUNT = 300;
+static const size_t FRAMES = 200;
+static const size_t EDITS_PER_FRAME = 20;
+
+static glm::mat4 makeLocal(float x, float y, float z, float scale)
+{
+	glm::mat4 m(scale);
+	m[3] = glm::vec4(x, y, z, 1.f);
+	return m;
+}
+
+static glm::mat4 randomLocal(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> offset(-2.f, 2.f);
+	std::uniform_real_distribution<float> scale(0.8f, 1.25f);
+	return makeLocal(offset(rng), offset(rng), offset(rng), scale(rng));
+}
+
+static bool nearlyEqual(const glm::mat4& a, const glm::mat4& b)
+{
+	for (int c = 0; c < 4; c++) {
+		for (int r = 0; r < 4; r++) {
+			if (std::abs(a[c][r] - b[c][r]) > 1e-3f * std::max(1.f, std::abs(b[c][r]))) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static glm::mat4 expectedWorld(const TransformStore& store, TransformId id)
+{
+	TransformId parent = store.Parent(id);
+	return parent == NULL_TRANSFORM ? store.Local(id) : store.World(parent) * store.Local(id);
+}
+
+static void checkWorlds(const TransformStore& store, const std::vector<TransformId>& alive)
+{
+	for (TransformId id : alive) {
+		CHECK(nearlyEqual(store.World(id), expectedWorld(store, id)));
+	}
+}
+
+static std::set<TransformId> update(TransformStore& store)
+{
+	const std::vector<TransformId>& changed = store.Update();
+	std::set<TransformId> unique(changed.begin(), changed.end());
+	CHECK(unique.size() == changed.size());
+	return unique;
+}
+
+static void testScenarios()
+{
+	TransformStore store;
+	TransformId root = store.Create();
+	TransformId child = store.Create(root);
+	TransformId grandChild = store.Create(child);
+	TransformId other = store.Create();
+
+	store.SetLocal(root, makeLocal(1.f, 0.f, 0.f, 2.f));
+	store.SetLocal(child, makeLocal(0.f, 1.f, 0.f, 1.f));
+	store.SetLocal(grandChild, makeLocal(0.f, 0.f, 1.f, 0.5f));
+	store.SetLocal(other, makeLocal(5.f, 5.f, 5.f, 1.f));
+
+	CHECK(update(store) == (std::set<TransformId>{ root, child, grandChild, other }));
+	checkWorlds(store, { root, child, grandChild, other });
+	CHECK(update(store).empty());
+
+	// Editing only a parent recomputes its whole subtree.
+	store.SetLocal(child, makeLocal(0.f, 2.f, 0.f, 1.f));
+	CHECK(update(store) == (std::set<TransformId>{ child, grandChild }));
+	checkWorlds(store, { root, child, grandChild, other });
+
+	// Parent and child edited in the same frame: the child must see the parent's new world matrix.
+	store.SetLocal(grandChild, makeLocal(3.f, 0.f, 0.f, 1.f));
+	store.SetLocal(root, makeLocal(-1.f, 0.f, 0.f, 3.f));
+	CHECK(update(store) == (std::set<TransformId>{ root, child, grandChild }));
+	checkWorlds(store, { root, child, grandChild, other });
+
+	// Reparenting moves the subtree under the new parent.
+	store.SetParent(child, other);
+	CHECK(store.Parent(child) == other);
+	CHECK(update(store) == (std::set<TransformId>{ child, grandChild }));
+	checkWorlds(store, { root, child, grandChild, other });
+
+	bool threw = false;
+	try {
+		store.SetParent(other, grandChild);
+	} catch (const std::runtime_error&) {
+		threw = true;
+	}
+	CHECK(threw);
+
+	// Destroying a parent makes its children roots that keep their local matrices.
+	glm::mat4 childLocal = store.Local(child);
+	store.Destroy(other);
+	CHECK(store.Parent(child) == NULL_TRANSFORM);
+	CHECK(store.Local(child) == childLocal);
+	CHECK(update(store) == (std::set<TransformId>{ child, grandChild }));
+	checkWorlds(store, { root, child, grandChild });
+	CHECK(nearlyEqual(store.World(child), childLocal));
+
+	// A transform destroyed while dirty is not reported.
+	store.SetLocal(root, makeLocal(0.f, 0.f, 0.f, 1.f));
+	store.Destroy(root);
+	CHECK(update(store).empty());
+}
+
+static void testRandom()
+{
+	TransformStore store;
+	std::mt19937 rng(9);
+	std::vector<TransformId> alive;
+
+	auto pick = [&]() { return alive[std::uniform_int_distribution<size_t>(0, alive.size() - 1)(rng)]; };
+
+	for (size_t i = 0; i < TRANSFORM_COUNT; i++) {
+		TransformId parent = alive.empty() || rng() % 4 == 0 ? NULL_TRANSFORM : pick();
+		TransformId id = store.Create(parent);
+		store.SetLocal(id, randomLocal(rng));
+		alive.push_back(id);
+	}
+	CHECK(update(store).size() == TRANSFORM_COUNT);
+	checkWorlds(store, alive);
+
+	std::uniform_int_distribution<int> action(0, 9);
+
+	for (size_t frame = 0; frame < FRAMES; frame++) {
+		// Every transform whose world matrix must be recomputed: edited ones and, after Update, their subtrees.
+		std::set<TransformId> edited;
+
+		for (size_t e = 0; e < EDITS_PER_FRAME; e++) {
+			int a = action(rng);
+			if (a < 5) {
+				TransformId id = pick();
+				store.SetLocal(id, randomLocal(rng));
+				edited.insert(id);
+			} else if (a < 8) {
+				TransformId id = pick();
+				TransformId parent = rng() % 4 == 0 ? NULL_TRANSFORM : pick();
+				try {
+					store.SetParent(id, parent);
+					edited.insert(id);
+				} catch (const std::runtime_error&) {
+					// Parenting to a descendant is rejected and must leave the hierarchy alone.
+				}
+			} else if (a < 9 && alive.size() > 1) {
+				size_t i = std::uniform_int_distribution<size_t>(0, alive.size() - 1)(rng);
+				TransformId id = alive[i];
+				std::vector<TransformId> children;
+				for (TransformId other : alive) {
+					if (store.Parent(other) == id) {
+						children.push_back(other);
+					}
+				}
+				store.Destroy(id);
+				edited.erase(id);
+				alive[i] = alive.back();
+				alive.pop_back();
+				for (TransformId c : children) {
+					CHECK(store.Parent(c) == NULL_TRANSFORM);
+					edited.insert(c);
+				}
+			} else {
+				TransformId id = store.Create(pick());
+				store.SetLocal(id, randomLocal(rng));
+				alive.push_back(id);
+				edited.insert(id);
+			}
+		}
+
+		std::set<TransformId> changed = update(store);
+		checkWorlds(store, alive);
+
+		std::set<TransformId> aliveSet(alive.begin(), alive.end());
+		for (TransformId id : changed) {
+			CHECK(aliveSet.count(id));
+		}
+
+		// Everything edited, and every descendant of something edited, was recomputed; nothing else was.
+		for (TransformId id : alive) {
+			bool expected = false;
+			for (TransformId p = id; p != NULL_TRANSFORM && !expected; p = store.Parent(p)) {
+				expected = edited.count(p) > 0;
+			}
+			CHECK(changed.count(id) == (expected ? 1 : 0));
+		}
+	}
+}
+
+int main()
+{
+	testScenarios();
+	testRandom();
+
+	std::printf("transform_store_test: %d failed checks\n", checkFailures);
+	return checkFailures ? 1 : 0;
+}